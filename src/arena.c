@@ -0,0 +1,132 @@
+/**
+ * @file arena.c
+ * @brief Implementation of the bump pointer allocator and the object pools on top of it
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "error.h"
+
+#define ALIGN_UP(size) (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+    size = ALIGN_UP(size);
+
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->capacity - block->used < size)
+    {
+        size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        if ((block = malloc(sizeof(ArenaBlock) + capacity)) == NULL)
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+        block->capacity = capacity;
+        block->used = 0;
+
+        // an oversized block is filled right away, so it goes behind the current one which still has some space left
+        if (capacity > ARENA_BLOCK_SIZE && arena->head != NULL)
+        {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        }
+
+        else
+        {
+            block->next = arena->head;
+            arena->head = block;
+        }
+    }
+
+    void *memory = block->data + block->used;
+    block->used += size;
+
+    return memory;
+}
+
+char *ArenaCopyString(Arena *arena, const char *string, size_t length)
+{
+    char *copy = ArenaAlloc(arena, length + 1);
+
+    if (length != 0)
+        memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+}
+
+void ArenaRelease(Arena *arena)
+{
+    ArenaBlock *block = arena->head;
+    while (block != NULL)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->head = NULL;
+}
+
+void ArenaReset(Arena *arena)
+{
+    if (arena->head == NULL)
+        return;
+
+    // the current block is kept, the older ones are freed
+    ArenaBlock *head = arena->head;
+    arena->head = head->next;
+    ArenaRelease(arena);
+
+    head->next = NULL;
+    head->used = 0;
+    arena->head = head;
+}
+
+void ArenaAdopt(Arena *arena, Arena *other)
+{
+    if (other->head == NULL)
+        return;
+
+    if (arena->head == NULL)
+        arena->head = other->head;
+
+    // the adopted blocks go behind the current one, so that its free space is still used
+    else
+    {
+        ArenaBlock *tail = other->head;
+        while (tail->next != NULL)
+            tail = tail->next;
+
+        tail->next = arena->head->next;
+        arena->head->next = other->head;
+    }
+
+    other->head = NULL;
+}
+
+void *PoolAlloc(Pool *pool)
+{
+    if (pool->free_list == NULL)
+        return ArenaAlloc(&pool->arena, pool->object_size);
+
+    void *object = pool->free_list;
+    pool->free_list = *(void **)object;
+    return object;
+}
+
+void PoolFree(Pool *pool, void *object)
+{
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+}
+
+void PoolRelease(Pool *pool)
+{
+    ArenaRelease(&pool->arena);
+    pool->free_list = NULL;
+}
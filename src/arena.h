@@ -0,0 +1,65 @@
+/**
+ * @file arena.h
+ * @brief Bump pointer allocator for data which lives as long as the whole compilation (tokens and their attributes)
+ *
+ * Allocations are carved out of large blocks and can't be freed one by one, ArenaRelease() frees all of them at once.
+ * A Pool hands out objects of one size (the symbols) from an arena and reuses the freed ones.
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "types.h"
+
+// Size of a regular arena block, bigger allocations get a block of their own
+#define ARENA_BLOCK_SIZE 65536
+
+// Every allocation is aligned to this, which is enough for anything that is put into the arena
+#define ARENA_ALIGNMENT (sizeof(void *))
+
+/**
+ * @brief Allocates uninitialized memory from the arena, exits with ERROR_INTERNAL if there is no memory left
+ *
+ * @param arena The arena to allocate from, a zero-initialized Arena is an empty one
+ * @param size Number of bytes
+ * @return void* Memory valid until the next ArenaRelease()
+ */
+void *ArenaAlloc(Arena *arena, size_t size);
+
+/**
+ * @brief Copies length characters of string to the arena and NUL-terminates the copy
+ *
+ * @param arena The arena to allocate from
+ * @param string Characters to copy, don't have to be NUL-terminated (and can contain '\0')
+ * @param length Number of characters to copy
+ * @return char* The copy
+ */
+char *ArenaCopyString(Arena *arena, const char *string, size_t length);
+
+// Frees every block of the arena, it can be used again afterwards
+void ArenaRelease(Arena *arena);
+
+// Invalidates everything allocated from the arena, but keeps one block around for the next allocations
+void ArenaReset(Arena *arena);
+
+// Moves every block of other to the arena (which keeps filling its current block), other is empty afterwards
+void ArenaAdopt(Arena *arena, Arena *other);
+
+/**
+ * @brief Allocates an uninitialized object from the pool, a freed one if there is any
+ *
+ * @param pool The pool, a zero-initialized Pool with object_size set is an empty one
+ * @return void* Memory for one object, valid until PoolFree()
+ */
+void *PoolAlloc(Pool *pool);
+
+// Returns an object to the pool, it's handed out again by the next PoolAlloc()
+void PoolFree(Pool *pool, void *object);
+
+// Frees the memory of the pool, every object allocated from it is invalid afterwards (freed or not)
+void PoolRelease(Pool *pool);
+
+#endif
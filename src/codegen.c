@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include "shared.h"
 #include "codegen.h"
@@ -85,13 +86,29 @@ void EndWhileLabel(int count)
     fprintf(stdout, "LABEL $endwhile%d\n", count);
 }
 
-void PUSHS(const char *attribute, TOKEN_TYPE type, FRAME frame)
+// Writes the operand part of a token after its prefix, numbers are printed from their parsed value
+static void WriteOperand(Token *token)
 {
+    // White space handling for string literals
+    if (token->token_type == LITERAL_TOKEN)
+        WriteStringLiteral(token->attribute, token->length);
+    else if (token->token_type == DOUBLE_64)
+        fprintf(stdout, "%a", token->value.floating);
+    else if (token->token_type == INTEGER_32)
+        fprintf(stdout, "%" PRId64, token->value.integer);
+    else
+        fprintf(stdout, "%.*s", token->length, token->attribute);
+}
+
+void PUSHS(Token *token, FRAME frame)
+{
+    TOKEN_TYPE type = token->token_type;
+
     // If the token is an identifier, push it from the correct frame
     if (type == IDENTIFIER_TOKEN)
     {
         char *frame_string = GetFrameString(frame);
-        fprintf(stdout, "PUSHS %s%s\n", frame_string, attribute);
+        fprintf(stdout, "PUSHS %s%.*s\n", frame_string, token->length, token->attribute);
         free(frame_string);
         return;
     }
@@ -105,18 +122,7 @@ void PUSHS(const char *attribute, TOKEN_TYPE type, FRAME frame)
 
     char *type_string = GetTypeStringToken(type);
     fprintf(stdout, "PUSHS %s", type_string);
-
-    // White space handling for string literals
-    if (type == LITERAL_TOKEN)
-        WriteStringLiteral(attribute);
-    else if (type == INTEGER_32)
-        fprintf(stdout, "%s", attribute);
-    else
-    {
-        double val = strtod(attribute, NULL);
-        fprintf(stdout, "%a", val);
-    }
-
+    WriteOperand(token);
     fprintf(stdout, "\n");
     free(type_string);
 }
@@ -124,34 +130,20 @@ void PUSHS(const char *attribute, TOKEN_TYPE type, FRAME frame)
 void MOVE(Token *dst, Token *src, FRAME dst_frame)
 {
     char *frame_string = GetFrameString(dst_frame);
-    fprintf(stdout, "MOVE %s%s ", frame_string, dst->attribute);
-    if (src->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(src->attribute);
-    else if (src->token_type == DOUBLE_64)
-        fprintf(stdout, "%a", strtod(src->attribute, NULL));
-    else
-        fprintf(stdout, "%s", src->attribute);
-
+    fprintf(stdout, "MOVE %s%.*s ", frame_string, dst->length, dst->attribute);
+    WriteOperand(src);
     fprintf(stdout, "\n");
 }
 
-void SETPARAM(int order, const char *value, TOKEN_TYPE type, FRAME frame)
+void SETPARAM(int order, Token *token, FRAME frame)
 {
     // Initial print of the target parameter variable
     fprintf(stdout, "MOVE TF@PARAM%d ", order);
 
     // Prefix is either GF@/LF@/TF@ or the type of the token (int@, float@0x, string@, bool@)
-    char *prefix = type == IDENTIFIER_TOKEN ? GetFrameString(frame) : GetTypeStringToken(type);
+    char *prefix = token->token_type == IDENTIFIER_TOKEN ? GetFrameString(frame) : GetTypeStringToken(token->token_type);
     fprintf(stdout, "%s", prefix);
-
-    // If the token is a string literal, call the WriteStringLiteral function to handle whitespaces accordingly
-    if (type == LITERAL_TOKEN)
-        WriteStringLiteral(value); // Why can't i use the ternary operator here :(((
-    else if (type == DOUBLE_64)
-        fprintf(stdout, "%a", strtod(value, NULL));
-    else
-        fprintf(stdout, "%s", value);
-
+    WriteOperand(token);
     fprintf(stdout, "\n");
 
     free(prefix);
@@ -279,12 +271,7 @@ void WRITEINSTRUCTION(Token *token, FRAME frame)
     fprintf(stdout, "WRITE %s", prefix);
 
     // Write the token attribute depenting on the type
-    if (token->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(token->attribute);
-    else if (token->token_type == DOUBLE_64)
-        fprintf(stdout, "%a", strtod(token->attribute, NULL));
-    else
-        fprintf(stdout, "%s", token->attribute);
+    WriteOperand(token);
     fprintf(stdout, "\n");
 
     free(prefix);
@@ -297,7 +284,9 @@ void INT2FLOAT(VariableSymbol *dst, Token *value, FRAME dst_frame, FRAME src_fra
     char *src_prefix = value->token_type == IDENTIFIER_TOKEN ? GetFrameString(src_frame) : strdup("int@");
     char *dst_prefix = GetFrameString(dst_frame);
 
-    fprintf(stdout, "INT2FLOAT %s%s %s%s\n", dst_prefix, dst->name, src_prefix, value->attribute);
+    fprintf(stdout, "INT2FLOAT %s%s %s", dst_prefix, dst->name, src_prefix);
+    WriteOperand(value);
+    fprintf(stdout, "\n");
 
     free(src_prefix);
     free(dst_prefix);
@@ -311,9 +300,9 @@ void FLOAT2INT(VariableSymbol *dst, Token *value, FRAME dst_frame, FRAME src_fra
     char *dst_prefix = GetFrameString(dst_frame);
 
     if (value->token_type == IDENTIFIER_TOKEN)
-        fprintf(stdout, "FLOAT2INT %s%s %s%s\n", dst_prefix, dst->name, src_prefix, value->attribute);
+        fprintf(stdout, "FLOAT2INT %s%s %s%.*s\n", dst_prefix, dst->name, src_prefix, value->length, value->attribute);
     else
-        fprintf(stdout, "FLOAT2INT %s%s %s%a\n", dst_prefix, dst->name, src_prefix, strtod(value->attribute, NULL));
+        fprintf(stdout, "FLOAT2INT %s%s %s%a\n", dst_prefix, dst->name, src_prefix, value->value.floating);
 
     free(src_prefix);
     free(dst_prefix);
@@ -326,7 +315,7 @@ void STRLEN(VariableSymbol *var, Token *src, FRAME dst_frame, FRAME src_frame)
     // Get the prefixes
     char *dst_prefix = GetFrameString(dst_frame);
     char *src_prefix = src->token_type == IDENTIFIER_TOKEN ? GetFrameString(src_frame) : strdup("string@");
-    fprintf(stdout, "STRLEN %s%s %s%s\n", dst_prefix, var->name, src_prefix, src->attribute);
+    fprintf(stdout, "STRLEN %s%s %s%.*s\n", dst_prefix, var->name, src_prefix, src->length, src->attribute);
 
     // Free the prefixes
     free(dst_prefix);
@@ -343,7 +332,7 @@ void CONCAT(VariableSymbol *dst, Token *prefix, Token *postfix, FRAME dst_frame,
     char *postfix_prefix = postfix->token_type == IDENTIFIER_TOKEN ? GetFrameString(postfix_frame) : strdup("string@");
 
     // Print the instruction
-    fprintf(stdout, "CONCAT %s%s %s%s %s%s\n", dst_prefix, dst->name, prefix_prefix, prefix->attribute, postfix_prefix, postfix->attribute);
+    fprintf(stdout, "CONCAT %s%s %s%.*s %s%.*s\n", dst_prefix, dst->name, prefix_prefix, prefix->length, prefix->attribute, postfix_prefix, postfix->length, postfix->attribute);
 
     // Free the prefixes
     free(dst_prefix);
@@ -361,7 +350,7 @@ void STRI2INT(VariableSymbol *var, Token *src, Token *position, FRAME dst_frame,
     char *position_prefix = position->token_type == IDENTIFIER_TOKEN ? GetFrameString(position_frame) : strdup("int@");
 
     // We assume that the type-checking has already been done, so error 58 won't occur
-    fprintf(stdout, "STRI2INT %s%s %s%s %s%s\n", dst_prefix, var->name, src_prefix, src->attribute, position_prefix, position->attribute);
+    fprintf(stdout, "STRI2INT %s%s %s%.*s %s%.*s\n", dst_prefix, var->name, src_prefix, src->length, src->attribute, position_prefix, position->length, position->attribute);
 
     // Deallocate the prefixes
     free(dst_prefix);
@@ -376,7 +365,7 @@ void INT2CHAR(VariableSymbol *dst, Token *value, FRAME dst_frame, FRAME src_fram
     // Get prefixes
     char *dst_prefix = GetFrameString(dst_frame);
     char *src_prefix = value->token_type == IDENTIFIER_TOKEN ? GetFrameString(src_frame) : strdup("int@");
-    fprintf(stdout, "INT2CHAR %s%s %s%s\n", dst_prefix, dst->name, src_prefix, value->attribute);
+    fprintf(stdout, "INT2CHAR %s%s %s%.*s\n", dst_prefix, dst->name, src_prefix, value->length, value->attribute);
 
     // Free the prefixes
     free(dst_prefix);
@@ -397,32 +386,32 @@ void STRCMP(VariableSymbol *var, Token *str1, Token *str2, FRAME dst_frame, FRAM
     // B1 will store the strings s1 > s2, B2 will store s2 > s1, if neither of those is true, the strings are equal
     fprintf(stdout, "GT GF@$B1 %s", str1_prefix);
     if (str1->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(str1->attribute);
+        WriteStringLiteral(str1->attribute, str1->length);
     else
-        fprintf(stdout, "%s", str1->attribute);
+        fprintf(stdout, "%.*s", str1->length, str1->attribute);
 
     // second operand
     fprintf(stdout, " %s", str2_prefix);
     if (str2->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(str2->attribute);
+        WriteStringLiteral(str2->attribute, str2->length);
     else
-        fprintf(stdout, "%s", str2->attribute);
+        fprintf(stdout, "%.*s", str2->length, str2->attribute);
 
     fprintf(stdout, "\n");
 
     // Do the same for B2
     fprintf(stdout, "GT GF@$B2 %s", str2_prefix);
     if (str2->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(str2->attribute);
+        WriteStringLiteral(str2->attribute, str2->length);
     else
-        fprintf(stdout, "%s", str2->attribute);
+        fprintf(stdout, "%.*s", str2->length, str2->attribute);
 
     // second operand
     fprintf(stdout, " %s", str1_prefix);
     if (str1->token_type == LITERAL_TOKEN)
-        WriteStringLiteral(str1->attribute);
+        WriteStringLiteral(str1->attribute, str1->length);
     else
-        fprintf(stdout, "%s", str1->attribute);
+        fprintf(stdout, "%.*s", str1->length, str1->attribute);
 
     fprintf(stdout, "\n");
 
@@ -466,11 +455,11 @@ void STRING(VariableSymbol *var, Token *src, FRAME dst_frame, FRAME src_frame)
     fprintf(stdout, "MOVE %s%s %s", dst_prefix, var->name, src_prefix);
     if (src->token_type == LITERAL_TOKEN)
     {
-        WriteStringLiteral(src->attribute);
+        WriteStringLiteral(src->attribute, src->length);
         fprintf(stdout, "\n");
     }
     else
-        fprintf(stdout, "%s\n", src->attribute);
+        fprintf(stdout, "%.*s\n", src->length, src->attribute);
     free(dst_prefix);
     free(src_prefix);
 }
@@ -493,7 +482,7 @@ void ORD(VariableSymbol *var, Token *string, Token *position, FRAME dst_frame, F
     */
 
     // Don't call STRLEN() since R0 is not represented by a token
-    fprintf(stdout, "STRLEN GF@$R0 %s%s\n", string_prefix, string->attribute);
+    fprintf(stdout, "STRLEN GF@$R0 %s%.*s\n", string_prefix, string->length, string->attribute);
 
     /* Pseudocode for how that might look like
         if R0 == 0 jump RETURN0ORD
@@ -507,11 +496,11 @@ void ORD(VariableSymbol *var, Token *string, Token *position, FRAME dst_frame, F
     JUMPIFEQ("ORDRETURN0", "GF@$R0", "int@0", ord_count) // If the string is empty, return 0
 
     // Check if the position isn't < 0
-    fprintf(stdout, "LT GF@$B2 %s%s int@0\n", position_prefix, position->attribute); // B2 = position < 0
+    fprintf(stdout, "LT GF@$B2 %s%.*s int@0\n", position_prefix, position->length, position->attribute); // B2 = position < 0
 
     // Now check if position > (R0 - 1)
     fprintf(stdout, "SUB GF@$R0 GF@$R0 int@1\n");
-    fprintf(stdout, "GT GF@$B1 %s%s GF@$R0\n", position_prefix, position->attribute);
+    fprintf(stdout, "GT GF@$B1 %s%.*s GF@$R0\n", position_prefix, position->length, position->attribute);
 
     // OR those two
     fprintf(stdout, "OR GF@$B0 GF@$B1 GF@$B2\n"); // B0 = B1 || B2
@@ -570,9 +559,9 @@ void SUBSTRING(VariableSymbol *var, Token *str, Token *beginning_index, Token *e
         JUMPIFEQ SUBSTRINGRETURNNULL B0 bool@true   if(B0) return NULL
     */
 
-    fprintf(stdout, "MOVE GF@$R0 %s%s\n", beginning_prefix, beginning_index->attribute); // R0 = beginning
-    fprintf(stdout, "MOVE GF@$R1 %s%s\n", end_prefix, end_index->attribute);             // R1 = end
-    fprintf(stdout, "STRLEN GF@$R2 %s%s\n", str_prefix, str->attribute);                 // R2 = length
+    fprintf(stdout, "MOVE GF@$R0 %s%.*s\n", beginning_prefix, beginning_index->length, beginning_index->attribute); // R0 = beginning
+    fprintf(stdout, "MOVE GF@$R1 %s%.*s\n", end_prefix, end_index->length, end_index->attribute);             // R1 = end
+    fprintf(stdout, "STRLEN GF@$R2 %s%.*s\n", str_prefix, str->length, str->attribute);                 // R2 = length
     fprintf(stdout, "LT GF@$B1 GF@$R0 int@0\n");                                         // B1 = beginning < 0
     fprintf(stdout, "LT GF@$B2 GF@$R1 int@0\n");                                         // B2 = end < 0
     fprintf(stdout, "OR GF@$B0 GF@$B1 GF@$B2\n");                                        // B0 = B1 || B2, conditions 1 and 2 marked off
@@ -617,7 +606,7 @@ void SUBSTRING(VariableSymbol *var, Token *str, Token *beginning_index, Token *e
     fprintf(stdout, "LABEL SUBSTRINGWHILE%d\n", substring_count);                // LABEL SUBSTRINGWHILE
     fprintf(stdout, "LT GF@$B0 GF@$R0 GF@$R1\n");                                // B0 = beginning < end
     JUMPIFEQ("SUBSTRINGWHILEEND", "GF@$B0", "bool@false", substring_count);      // while(beginning < end)
-    fprintf(stdout, "GETCHAR GF@$S1 %s%s GF@$R0\n", str_prefix, str->attribute); // S1 = str[beginning]
+    fprintf(stdout, "GETCHAR GF@$S1 %s%.*s GF@$R0\n", str_prefix, str->length, str->attribute); // S1 = str[beginning]
     JUMPIFEQ("SUBSTRINGFIRSTCHAR", "GF@$B2", "bool@true", substring_count);      // if(B2) goto FIRSTCHAR
     fprintf(stdout, "CONCAT GF@$S0 GF@$S0 GF@$S1\n");                            // else{ S0 = S0 + S1
     fprintf(stdout, "JUMP SUBSTRINGNOTFIRSTCHAR%d\n", substring_count);          // goto NOTFIRSTCHAR
@@ -647,12 +636,16 @@ void SUBSTRING(VariableSymbol *var, Token *str, Token *beginning_index, Token *e
     substring_count++;
 }
 
-void WriteStringLiteral(const char *str)
+void WriteStringLiteral(const char *str, int length)
 {
-    for (int i = 0; i < (int)strlen(str); i++)
+    for (int i = 0; i < length; i++)
     {
         switch (str[i])
         {
+        case '\0':
+            fprintf(stdout, "\\000");
+            break;
+
         case '\n':
             fprintf(stdout, "\\010");
             break;
@@ -141,21 +141,19 @@ void MOVE(Token *dst, Token *src, FRAME dst_frame);
 /**
  * @brief Generates code for pushing a symbol to the data stack.
  *
- * @param attribute String representation of the token.
- * @param type Token type.
+ * @param token The identifier/literal to push, numbers are printed from token->value.
  * @param frame Frame type. Ignored if token type is not IDENTIFIER_TOKEN.
  */
-void PUSHS(const char *attribute, TOKEN_TYPE type, FRAME frame);
+void PUSHS(Token *token, FRAME frame);
 
 /**
  * @brief Generates code for moving a value to a function's parameter
  *
  * @param order The number/order of the parameter, for example the first param is TF@param0... etc.
- * @param value The string representation of the value.
- * @param type Token type.
+ * @param token The identifier/literal to move, numbers are printed from token->value.
  * @param frame Frame type. Ignored if token type is not IDENTIFIER_TOKEN.
  */
-void SETPARAM(int order, const char *value, TOKEN_TYPE type, FRAME frame);
+void SETPARAM(int order, Token *token, FRAME frame);
 
 // Makes the print instructions a bit less bloated
 char *GetFrameString(FRAME frame);
@@ -208,8 +206,11 @@ void SUBSTRING(VariableSymbol *var, Token *str, Token *beginning_index, Token *e
 
 /**
  * @brief Writes the string literal passed in as a param in a IFJCode24 compatible way.
+ *
+ * @param str The literal, can contain '\0' (from a \x00 escape sequence) so it isn't treated as a C string.
+ * @param length Number of characters to write.
  */
-void WriteStringLiteral(const char *str);
+void WriteStringLiteral(const char *str, int length);
 
 /**
  * @brief Pushes the return value of a function to the data stack, depending on the return type.
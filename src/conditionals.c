@@ -24,6 +24,8 @@
 #include "symtable.h"
 #include "vector.h"
 #include "stack.h"
+#include "scanner.h"
+#include "interner.h"
 
 bool IsIfNullableType(Parser *parser)
 {
@@ -58,7 +60,7 @@ bool IsIfNullableType(Parser *parser)
         case EOF_TOKEN:
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_SYNTACTIC, "Line %d: Incorrectly ended if statement", parser->line_number);
             break; // gcc would complain about missing break, but it's not needed here
 
@@ -96,12 +98,12 @@ void ParseIfStatement(Parser *parser)
 
     // Parse the inside expression
     TokenVector *postfix = InfixToPostfix(parser);
-    DATA_TYPE expr_type = ParseExpression(postfix, parser);
+    DATA_TYPE expr_type = ParseExpression(postfix, parser, NULL);
 
     // Check if the expression is a boolean
     if (expr_type != BOOLEAN)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SEMANTIC_TYPE_COMPATIBILITY, "Line %d: Expected boolean expression in conditional", parser->line_number);
@@ -144,8 +146,7 @@ void ParseIfStatement(Parser *parser)
     ElseLabel(if_id);
 
     // Pop the if body symtable
-    SymtableStackPush(parser->symtable_stack, InitSymtable(TABLE_COUNT));
-    parser->symtable = SymtableStackTop(parser->symtable_stack);
+    SymtableStackPush(parser->symtable_stack);
 
     // Else body
     ProgramBody(parser);
@@ -173,15 +174,15 @@ void ParseNullableIfStatement(Parser *parser)
     Token *token = CheckAndReturnTokenVector(parser, IDENTIFIER_TOKEN);
 
     // Get the symbol representing the variable
-    VariableSymbol *var = SymtableStackFindVariable(parser->symtable_stack, token->attribute);
+    VariableSymbol *var = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id);
 
     // Undefined case
     if (var == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, token->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, token->length, token->attribute);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_UNDEFINED);
     }
 
@@ -191,7 +192,7 @@ void ParseNullableIfStatement(Parser *parser)
         PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is not of a nullable type", var->name);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_TYPE_COMPATIBILITY);
     }
     var->was_used = true;
@@ -224,7 +225,8 @@ void ParseNullableIfStatement(Parser *parser)
     VariableSymbol *new = VariableSymbolInit();
     new->defined = true;
     new->is_const = false;
-    new->name = strdup(token->attribute);
+    new->name = InternedName(token->symbol_id);
+    new->symbol_id = token->symbol_id;
     new->type = NullableToNormal(var->type);
 
     // New entry in the symtable
@@ -258,8 +260,7 @@ void ParseNullableIfStatement(Parser *parser)
     ElseLabel(if_id);
 
     // Pop the if body symtable
-    SymtableStackPush(parser->symtable_stack, InitSymtable(TABLE_COUNT));
-    parser->symtable = SymtableStackTop(parser->symtable_stack);
+    SymtableStackPush(parser->symtable_stack);
 
     // Else body
     ProgramBody(parser);
@@ -15,6 +15,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#include <errno.h>
 
 #include "shared.h"
 #include "scanner.h"
@@ -29,41 +31,61 @@
 #include "stack.h"
 #include "loop.h"
 #include "conditionals.h"
+#include "interner.h"
+#include "parallel_scan.h"
 
 Parser InitParser()
 {
     Parser parser =
         {
             .current_function = NULL,
-            .global_symtable = InitSymtable(TABLE_COUNT),
+            .global_symtable = InitSymtable(SYMTABLE_INITIAL_CAPACITY),
             .has_main = false,
             .end_of_program = false,
             .line_number = 1,
             .nested_level = 0,
-            .symtable = InitSymtable(TABLE_COUNT),
             .symtable_stack = SymtableStackInit(),
             .parsing_functions = true};
 
-    // Push the initial symtable to the top of the stack and add embedded functions to the global one
-    SymtableStackPush(parser.symtable_stack, parser.symtable);
+    // The names the parser looks for are interned before anything else, so that they are compared by id
+    ifj_symbol_id = InternString("ifj", 3);
+    main_symbol_id = InternString("main", 4);
+
+    // Open the outermost scope and add embedded functions to the global symtable
+    SymtableStackPush(parser.symtable_stack);
     InsertEmbeddedFunctions(&parser);
 
     return parser;
 }
 
-Token *GetNextToken(Parser *parser)
+// Moves to the next token of the stream and returns its index
+static int NextStreamIndex(Parser *parser)
 {
     if (stream_index >= stream->length)
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_INTERNAL, "Calling GetNextToken out of bounds. Fix your code!!!");
     }
 
-    Token *token = stream->token_string[stream_index++];
-    parser->line_number = token->line_number;
-    return token;
+    parser->line_number = StreamLineNumber(stream, stream_index);
+    return stream_index++;
+}
+
+Token *GetNextToken(Parser *parser)
+{
+    return StreamToken(stream, NextStreamIndex(parser));
+}
+
+TOKEN_TYPE GetNextTokenType(Parser *parser)
+{
+    return StreamTokenType(stream, NextStreamIndex(parser));
+}
+
+KEYWORD_TYPE GetNextKeywordType(Parser *parser)
+{
+    return StreamKeywordType(stream, NextStreamIndex(parser));
 }
 
 void ProgramBegin()
@@ -78,77 +100,72 @@ void ProgramBegin()
 void CheckTokenTypeStream(Parser *parser, TOKEN_TYPE type)
 {
     Token *token;
-    if ((token = LoadTokenFromStream(&parser->line_number))->token_type != type)
+    if ((token = ScanToken(&parser->line_number))->token_type != type)
     {
-        DestroyToken(token);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, " Expected '%s' at line %d",
                   token_types[type], parser->line_number);
     }
 
     else
-        AppendToken(stream, token);
+        StreamAppendToken(stream, token);
 }
 
 // checks if the next token is of the expected keyword type
 void CheckKeywordTypeStream(Parser *parser, KEYWORD_TYPE type)
 {
     Token *token;
-    if ((token = LoadTokenFromStream(&parser->line_number))->keyword_type != type)
+    if ((token = ScanToken(&parser->line_number))->keyword_type != type)
     {
-        DestroyToken(token);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, "Expected '%s' keyword at line %d",
                   keyword_types[type], parser->line_number);
     }
 
     else
-        AppendToken(stream, token);
+        StreamAppendToken(stream, token);
 }
 
 // checks if the next token is of the expected type and returns it
 Token *CheckAndReturnTokenStream(Parser *parser, TOKEN_TYPE type)
 {
     Token *token;
-    if ((token = LoadTokenFromStream(&parser->line_number))->token_type != type)
+    if ((token = ScanToken(&parser->line_number))->token_type != type)
     {
-        DestroyToken(token);
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, " Expected '%s' at line %d",
                   token_types[type], parser->line_number);
     }
-    AppendToken(stream, token);
+    StreamAppendToken(stream, token);
     return token;
 }
 
 Token *CheckAndReturnKeywordStream(Parser *parser, KEYWORD_TYPE type)
 {
     Token *token;
-    if ((token = LoadTokenFromStream(&parser->line_number))->keyword_type != type)
+    if ((token = ScanToken(&parser->line_number))->keyword_type != type)
     {
-        DestroyToken(token);
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, "Expected '%s' keyword at line %d",
                   keyword_types[type], parser->line_number);
     }
-    AppendToken(stream, token);
+    StreamAppendToken(stream, token);
     return token;
 }
 
 void CheckTokenTypeVector(Parser *parser, TOKEN_TYPE type)
 {
-    Token *token;
-    if ((token = GetNextToken(parser))->token_type != type)
+    if (GetNextTokenType(parser) != type)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, " Expected '%s' at line %d",
@@ -158,10 +175,9 @@ void CheckTokenTypeVector(Parser *parser, TOKEN_TYPE type)
 
 void CheckKeywordTypeVector(Parser *parser, KEYWORD_TYPE type)
 {
-    Token *token;
-    if ((token = GetNextToken(parser))->keyword_type != type)
+    if (GetNextKeywordType(parser) != type)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, "Expected '%s' keyword at line %d",
@@ -174,7 +190,7 @@ Token *CheckAndReturnTokenVector(Parser *parser, TOKEN_TYPE type)
     Token *token;
     if ((token = GetNextToken(parser))->token_type != type)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, " Expected '%s' at line %d",
@@ -188,7 +204,7 @@ Token *CheckAndReturnKeywordVector(Parser *parser, KEYWORD_TYPE type)
     Token *token;
     if ((token = GetNextToken(parser))->keyword_type != type)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, "Expected '%s' keyword at line %d",
@@ -201,8 +217,8 @@ VariableSymbol *IsVariableAssignment(Token *token, Parser *parser)
 {
     VariableSymbol *var;
 
-    // Not a function, and a recognized variable
-    if (FindFunctionSymbol(parser->global_symtable, token->attribute) == NULL && (var = SymtableStackFindVariable(parser->symtable_stack, token->attribute)) != NULL)
+    // A recognized variable (which can't be a function, InsertVariableSymbol() doesn't allow names of functions)
+    if ((var = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id)) != NULL)
     {
         // The next token has to be an '=' operator, a variable by itself is not an expression
         CheckTokenTypeVector(parser, ASSIGNMENT);
@@ -216,28 +232,23 @@ VariableSymbol *IsVariableAssignment(Token *token, Parser *parser)
 bool IsFunctionCall(Parser *parser)
 {
     stream_index--;
-    Token *id = GetNextToken(parser);
-    Token *braces = GetNextToken(parser);
-    if (id->token_type == IDENTIFIER_TOKEN && braces->token_type == L_ROUND_BRACKET)
-    {
-        stream_index -= 2;
-        return true;
-    }
+    TOKEN_TYPE id = GetNextTokenType(parser);
+    TOKEN_TYPE braces = GetNextTokenType(parser);
 
     stream_index -= 2;
-    return false;
+    return id == IDENTIFIER_TOKEN && braces == L_ROUND_BRACKET;
 }
 
 void PrintStreamTokens(Parser *parser)
 {
     for (int i = 0; i < stream->length; i++)
     {
-        PrintToken(stream->token_string[i]);
+        PrintToken(StreamToken(stream, i));
     }
-    // DestroyTokenVector(stream);
+    // DestroyStream();
     SymtableStackDestroy(parser->symtable_stack);
     DestroySymtable(parser->global_symtable);
-    DestroyTokenVector(stream);
+    DestroyStream();
     exit(SUCCESS);
 }
 
@@ -247,9 +258,9 @@ void Header(Parser *parser)
     CheckKeywordTypeVector(parser, CONST);
 
     Token *ifj = CheckAndReturnTokenVector(parser, IDENTIFIER_TOKEN);
-    if (strcmp(ifj->attribute, "ifj") != 0)
+    if (!SYMBOL_IDS_EQUAL(ifj->symbol_id, ifj_symbol_id))
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, "Expected 'ifj' at line %d", parser->line_number);
@@ -260,9 +271,9 @@ void Header(Parser *parser)
     CheckTokenTypeVector(parser, L_ROUND_BRACKET);
 
     Token *import_ifj24 = CheckAndReturnTokenVector(parser, LITERAL_TOKEN);
-    if (strcmp(import_ifj24->attribute, "ifj24.zig") != 0)
+    if (!AttributeEquals(import_ifj24, "ifj24.zig"))
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SYNTACTIC, "Expected 'ifj24.zig' at line %d", parser->line_number);
@@ -276,9 +287,7 @@ void Header(Parser *parser)
 // if(expression){}else{}
 void IfElse(Parser *parser)
 {
-    Symtable *symtable = InitSymtable(TABLE_COUNT);
-    SymtableStackPush(parser->symtable_stack, symtable);
-    parser->symtable = symtable;
+    SymtableStackPush(parser->symtable_stack);
 
     if (!IsIfNullableType(parser))
         ParseIfStatement(parser);
@@ -289,9 +298,7 @@ void IfElse(Parser *parser)
 
 void WhileLoop(Parser *parser)
 {
-    Symtable *symtable = InitSymtable(TABLE_COUNT);
-    SymtableStackPush(parser->symtable_stack, symtable);
-    parser->symtable = symtable;
+    SymtableStackPush(parser->symtable_stack);
 
     if (!IsLoopNullableType(parser))
         ParseWhileLoop(parser);
@@ -308,7 +315,8 @@ void VarDeclaration(Parser *parser, bool is_const)
 
     // add to symtable
     VariableSymbol *var = VariableSymbolInit();
-    var->name = strdup(token->attribute);
+    var->name = InternedName(token->symbol_id);
+    var->symbol_id = token->symbol_id;
     var->is_const = is_const;
     var->type = VOID_TYPE;
 
@@ -321,7 +329,7 @@ void VarDeclaration(Parser *parser, bool is_const)
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, "Expected '=' or ':' at line %d", parser->line_number);
     }
 
@@ -333,9 +341,9 @@ void VarDeclaration(Parser *parser, bool is_const)
 
         if (token->token_type != KEYWORD || (token->keyword_type != I32 && token->keyword_type != F64 && token->keyword_type != U8))
         {
-            DestroyTokenVector(stream);
-            DestroySymtable(parser->global_symtable);
+            DestroyStream();
             SymtableStackDestroy(parser->symtable_stack);
+            DestroySymtable(parser->global_symtable);
             ErrorExit(ERROR_SYNTACTIC, "Expected data type at line %d", parser->line_number);
         }
         var->type = token->keyword_type == I32 ? INT32_TYPE : token->keyword_type == F64 ? DOUBLE64_TYPE
@@ -355,7 +363,7 @@ void VarDeclaration(Parser *parser, bool is_const)
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, "Expected '=' at line %d", parser->line_number);
     }
 
@@ -369,21 +377,20 @@ void VarDeclaration(Parser *parser, bool is_const)
 
 bool ConstValueAssignment(VariableSymbol *var)
 {
-    Token *potential_value = stream->token_string[stream_index];
-    Token *potential_semicolon = stream->token_string[stream_index + 1];
-
     // If the [next + 1] token is a semicolon, we can check the value
-    if (potential_semicolon->token_type == SEMICOLON)
+    if (StreamTokenType(stream, stream_index + 1) == SEMICOLON)
     {
+        Token *potential_value = StreamToken(stream, stream_index);
         switch (potential_value->token_type)
         {
         // Valid types in expression
         case INTEGER_32:
             if (var->type == INT32_TYPE || var->type == INT32_NULLABLE_TYPE || var->type == VOID_TYPE)
             {
-                var->value = strdup(potential_value->attribute);
+                var->value = AttributeToString(potential_value);
+                var->const_value = potential_value->value;
                 stream_index += 2;
-                fprintf(stdout, "MOVE LF@%s int@%s\n", var->name, var->value);
+                fprintf(stdout, "MOVE LF@%s int@%" PRId64 "\n", var->name, var->const_value.integer);
                 return true;
             }
 
@@ -392,9 +399,10 @@ bool ConstValueAssignment(VariableSymbol *var)
         case DOUBLE_64:
             if (var->type == DOUBLE64_TYPE || var->type == DOUBLE64_NULLABLE_TYPE || var->type == VOID_TYPE)
             {
-                var->value = strdup(potential_value->attribute);
+                var->value = AttributeToString(potential_value);
+                var->const_value = potential_value->value;
                 stream_index += 2;
-                fprintf(stdout, "MOVE LF@%s float@%a\n", var->name, strtod(var->value, NULL));
+                fprintf(stdout, "MOVE LF@%s float@%a\n", var->name, var->const_value.floating);
                 return true;
             }
 
@@ -403,7 +411,7 @@ bool ConstValueAssignment(VariableSymbol *var)
         case KEYWORD:
             if (potential_value->keyword_type == NULL_TYPE && var->nullable)
             {
-                var->value = strdup(potential_value->attribute);
+                var->value = AttributeToString(potential_value);
                 stream_index += 2;
                 fprintf(stdout, "MOVE LF@%s nil@nil\n", var->name);
                 return true;
@@ -427,8 +435,8 @@ void FunctionCall(Parser *parser, FunctionSymbol *func, const char *fun_name, DA
     {
         PrintError("Line %d: Invalid return type for function \"%s\"",
                    parser->line_number, fun_name);
-        SymtableStackDestroy(parser->symtable_stack);
-        DestroySymtable(parser->global_symtable);
+        CLEANUP
+        exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
     }
 
     CREATEFRAME
@@ -467,7 +475,7 @@ void ParametersOnCall(Parser *parser, FunctionSymbol *func)
 
             // Everything's fine, generate code
             NEWPARAM(loaded)
-            SETPARAM(loaded++, token->attribute, token->token_type, LOCAL_FRAME);
+            SETPARAM(loaded++, token, LOCAL_FRAME);
 
             // Check if the next token is a comma or a closing bracket
             if ((token = GetNextToken(parser))->token_type != R_ROUND_BRACKET && token->token_type != COMMA_TOKEN)
@@ -491,12 +499,12 @@ void ParametersOnCall(Parser *parser, FunctionSymbol *func)
                 INVALID_PARAM_COUNT
 
             // Check if the identifier is defined
-            else if ((symb1 = SymtableStackFindVariable(parser->symtable_stack, token->attribute)) == NULL)
+            else if ((symb1 = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id)) == NULL)
             {
-                PrintError("Line %d: Undefined variable \"%s\"", parser->line_number, token->attribute);
-                DestroySymtable(parser->global_symtable);
+                PrintError("Line %d: Undefined variable \"%.*s\"", parser->line_number, token->length, token->attribute);
                 SymtableStackDestroy(parser->symtable_stack);
-                DestroyTokenVector(stream);
+                DestroySymtable(parser->global_symtable);
+                DestroyStream();
                 exit(ERROR_SEMANTIC_UNDEFINED);
             }
 
@@ -508,7 +516,7 @@ void ParametersOnCall(Parser *parser, FunctionSymbol *func)
 
             // Generate code
             NEWPARAM(loaded)
-            SETPARAM(loaded++, token->attribute, token->token_type, LOCAL_FRAME);
+            SETPARAM(loaded++, token, LOCAL_FRAME);
 
             // Check if the next token is a comma or a closing bracket
             if ((token = GetNextToken(parser))->token_type != R_ROUND_BRACKET && token->token_type != COMMA_TOKEN)
@@ -527,7 +535,7 @@ void ParametersOnCall(Parser *parser, FunctionSymbol *func)
 
         // Invalid token
         default:
-            fprintf(stderr, "Unexpected token \"%s\"\n", token->attribute);
+            fprintf(stderr, "Unexpected token \"%.*s\"\n", token->length, token->attribute);
             INVALID_PARAM_TOKEN
         }
         if (break_flag)
@@ -558,11 +566,11 @@ void FunctionDefinition(Parser *parser)
     // These next few lines should ALWAYS run succesfully, since the function parser already checks them
     CheckKeywordTypeVector(parser, FN);
     Token *token = CheckAndReturnTokenVector(parser, IDENTIFIER_TOKEN);
-    FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, token->attribute);
+    FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, token->symbol_id);
 
     // Generate code for the function label
     FUNCTIONLABEL(func->name)
-    if (!strcmp(func->name, "main"))
+    if (SYMBOL_IDS_EQUAL(func->symbol_id, main_symbol_id))
         CREATEFRAME
     PUSHFRAME
 
@@ -576,16 +584,14 @@ void FunctionDefinition(Parser *parser)
     while ((token = GetNextToken(parser))->token_type != L_CURLY_BRACKET)
         continue;
 
-    // Create a new symtable for the function's stack frame
-    Symtable *symtable = InitSymtable(TABLE_COUNT);
-    SymtableStackPush(parser->symtable_stack, symtable);
-    parser->symtable = symtable;
+    // Open a new scope for the function's stack frame
+    SymtableStackPush(parser->symtable_stack);
 
     // Add the function parameters to the symtable and define them on the local frame
     for (int i = 0; i < func->num_of_parameters; i++)
     {
         // Check for redefinition of the parameter
-        if (FindVariableSymbol(symtable, func->parameters[i]->name) != NULL)
+        if (SymtableStackFindInTop(parser->symtable_stack, func->parameters[i]->symbol_id) != NULL)
         {
             PrintError("Error in semantic analysis: Line %d: Redefinition of parameter \"%s\" in function \"%s\"",
                        parser->line_number, func->parameters[i]->name, func->name);
@@ -609,7 +615,7 @@ void FunctionDefinition(Parser *parser)
     ProgramBody(parser);
 
     // If the function is main, exit at the end
-    if (!strcmp(func->name, "main"))
+    if (SYMBOL_IDS_EQUAL(func->symbol_id, main_symbol_id))
         IFJ24SUCCESS
 
     // Also if it's a void function put a return at the end
@@ -626,12 +632,13 @@ void FunctionDefinition(Parser *parser)
                    parser->line_number, func->name);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_MISSING_EXPR);
     }
 
-    // Not in a function anymore
+    // Not in a function anymore, so none of its tokens are referenced either
     parser->current_function = NULL;
+    RecycleTokens();
 }
 
 void FunctionReturn(Parser *parser)
@@ -643,13 +650,13 @@ void FunctionReturn(Parser *parser)
     parser->current_function->has_return = true;
 
     Token *token;
-    if (!strcmp(parser->current_function->name, "main")) // In main, return exits the program
+    if (SYMBOL_IDS_EQUAL(parser->current_function->symbol_id, main_symbol_id)) // In main, return exits the program
     {
         if ((token = GetNextToken(parser))->token_type != SEMICOLON)
         {
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_SEMANTIC_MISSING_EXPR, "Line %d: Invalid usage of \"return\" in main function (unexpected expression)");
         }
         POPFRAME
@@ -666,7 +673,7 @@ void FunctionReturn(Parser *parser)
                        parser->line_number, parser->current_function->name);
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             exit(ERROR_SEMANTIC_MISSING_EXPR);
         }
 
@@ -689,7 +696,7 @@ void FunctionReturn(Parser *parser)
                        parser->line_number, parser->current_function->name);
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             exit(ERROR_SEMANTIC_MISSING_EXPR);
         }
 
@@ -702,9 +709,9 @@ void FunctionReturn(Parser *parser)
 
         // Case 1
         Token *potential_operand = GetNextToken(parser);
-        Token *potential_semicolon = GetNextToken(parser);
+        TOKEN_TYPE potential_semicolon = GetNextTokenType(parser);
 
-        if (potential_semicolon->token_type == SEMICOLON)
+        if (potential_semicolon == SEMICOLON)
         {
             VariableSymbol *potential_retval = NULL;
             switch (potential_operand->token_type)
@@ -718,7 +725,7 @@ void FunctionReturn(Parser *parser)
                     exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
                 }
 
-                fprintf(stdout, "PUSHS int@%s\n", potential_operand->attribute);
+                fprintf(stdout, "PUSHS int@%" PRId64 "\n", potential_operand->value.integer);
                 POPFRAME
                 FUNCTION_RETURN
                 return;
@@ -732,7 +739,7 @@ void FunctionReturn(Parser *parser)
                     exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
                 }
 
-                fprintf(stdout, "PUSHS float@%a\n", strtod(potential_operand->attribute, NULL));
+                fprintf(stdout, "PUSHS float@%a\n", potential_operand->value.floating);
                 POPFRAME
                 FUNCTION_RETURN
                 return;
@@ -740,8 +747,8 @@ void FunctionReturn(Parser *parser)
             case KEYWORD:
                 if (token->keyword_type != NULL_TYPE)
                 {
-                    PrintError("Error in syntax analysis: Line %d: Unexpected token \"%s\" in return statement",
-                               parser->line_number, token->attribute);
+                    PrintError("Error in syntax analysis: Line %d: Unexpected token \"%.*s\" in return statement",
+                               parser->line_number, token->length, token->attribute);
                     CLEANUP
                     exit(ERROR_SYNTACTIC);
                 }
@@ -761,13 +768,13 @@ void FunctionReturn(Parser *parser)
                 return;
 
             case IDENTIFIER_TOKEN:
-                potential_retval = SymtableStackFindVariable(parser->symtable_stack, potential_operand->attribute);
+                potential_retval = SymtableStackFindVariable(parser->symtable_stack, potential_operand->symbol_id);
 
                 // Check if the variable is defined
                 if (potential_retval == NULL)
                 {
-                    PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"",
-                               parser->line_number, potential_operand->attribute);
+                    PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"",
+                               parser->line_number, potential_operand->length, potential_operand->attribute);
                     CLEANUP
                     exit(ERROR_SEMANTIC_UNDEFINED);
                 }
@@ -784,14 +791,14 @@ void FunctionReturn(Parser *parser)
                     exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
                 }
 
-                fprintf(stdout, "PUSHS LF@%s\n", potential_operand->attribute);
+                fprintf(stdout, "PUSHS LF@%.*s\n", potential_operand->length, potential_operand->attribute);
                 POPFRAME
                 FUNCTION_RETURN
                 return;
 
             default:
-                PrintError("Error in syntax analysis: Line %d: Unexpected token \"%s\" in return statement",
-                           parser->line_number, token->attribute);
+                PrintError("Error in syntax analysis: Line %d: Unexpected token \"%.*s\" in return statement",
+                           parser->line_number, token->length, token->attribute);
                 CLEANUP
                 exit(ERROR_SYNTACTIC);
             }
@@ -805,7 +812,7 @@ void FunctionReturn(Parser *parser)
 
             // The returned type is now on top of the data stack
             TokenVector *postfix = InfixToPostfix(parser);
-            DATA_TYPE expr_type = ParseExpression(postfix, parser);
+            DATA_TYPE expr_type = ParseExpression(postfix, parser, NULL);
 
             // Invalid return type
             if (expr_type != parser->current_function->return_type)
@@ -815,7 +822,7 @@ void FunctionReturn(Parser *parser)
                            parser->line_number, parser->current_function->name);
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
             }
 
@@ -864,11 +871,11 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
     {
         // Get the function name to use as a key into the hash table
         Token *func_name = GetNextToken(parser);
-        FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, func_name->attribute);
+        FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, func_name->symbol_id);
         if (func == NULL)
         {
-            PrintError("Error in semantic analysis: Line %d: Undefined function \"%s\"",
-                       parser->line_number, func_name->attribute);
+            PrintError("Error in semantic analysis: Line %d: Undefined function \"%.*s\"",
+                       parser->line_number, func_name->length, func_name->attribute);
             CLEANUP
             exit(ERROR_SEMANTIC_UNDEFINED);
         }
@@ -879,7 +886,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
 
     // Check for a embedded function call
     Token *token = GetNextToken(parser);
-    if (!strcmp(token->attribute, "ifj"))
+    if (SYMBOL_IDS_EQUAL(token->symbol_id, ifj_symbol_id))
     {
         FunctionSymbol *func = IsEmbeddedFunction(parser);
         stream_index += 2;                       // skip the 'ifj' and the '.' token
@@ -910,7 +917,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
     else if (token->keyword_type == NULL_TYPE)
     {
         // Assigning only NULL
-        if (GetNextToken(parser)->token_type == SEMICOLON)
+        if (GetNextTokenType(parser) == SEMICOLON)
         {
             // Type derivation error
             if (!is_underscore && var->type == VOID_TYPE)
@@ -927,7 +934,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
                            parser->line_number, var->name);
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 exit(ERROR_SEMANTIC_TYPE_COMPATIBILITY);
             }
 
@@ -955,10 +962,10 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
         - The expression is a complex expression and a semicolon follows
     */
     Token *potential_operand = GetNextToken(parser);
-    Token *potential_semicolon = GetNextToken(parser);
+    TOKEN_TYPE potential_semicolon = GetNextTokenType(parser);
 
     // Case 1
-    if (potential_semicolon->token_type == SEMICOLON)
+    if (potential_semicolon == SEMICOLON)
     {
         // Because FOR SOME REASON, C doesn't allow you to declare variables at the start of a switch case
         VariableSymbol *potential_operand_symbol = NULL;
@@ -970,7 +977,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
 
             else if (AreTypesCompatible(var->type, INT32_TYPE) || var->type == VOID_TYPE)
             {
-                fprintf(stdout, "MOVE LF@%s int@%s\n", var->name, potential_operand->attribute);
+                fprintf(stdout, "MOVE LF@%s int@%" PRId64 "\n", var->name, potential_operand->value.integer);
                 var->type = INT32_TYPE;
                 var->defined = true;
                 return;
@@ -992,7 +999,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
 
             else if (AreTypesCompatible(var->type, DOUBLE64_TYPE) || var->type == VOID_TYPE)
             {
-                fprintf(stdout, "MOVE LF@%s float@%a\n", var->name, strtod(potential_operand->attribute, NULL));
+                fprintf(stdout, "MOVE LF@%s float@%a\n", var->name, potential_operand->value.floating);
                 var->type = DOUBLE64_TYPE;
                 var->defined = true;
                 return;
@@ -1011,8 +1018,8 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
         case KEYWORD:
             if (potential_operand->keyword_type != NULL_TYPE)
             {
-                PrintError("Error in syntax analysis: Line %d: Unexpected token \"%s\" in assignment",
-                           parser->line_number, potential_operand->attribute);
+                PrintError("Error in syntax analysis: Line %d: Unexpected token \"%.*s\" in assignment",
+                           parser->line_number, potential_operand->length, potential_operand->attribute);
                 CLEANUP
                 exit(ERROR_SYNTACTIC);
             }
@@ -1044,13 +1051,13 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
             break;
 
         case IDENTIFIER_TOKEN:
-            potential_operand_symbol = SymtableStackFindVariable(parser->symtable_stack, potential_operand->attribute);
+            potential_operand_symbol = SymtableStackFindVariable(parser->symtable_stack, potential_operand->symbol_id);
 
             // Undefined case
             if (potential_operand_symbol == NULL)
             {
-                PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"",
-                           parser->line_number, potential_operand->attribute);
+                PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"",
+                           parser->line_number, potential_operand->length, potential_operand->attribute);
                 CLEANUP
                 exit(ERROR_SEMANTIC_UNDEFINED);
             }
@@ -1061,7 +1068,7 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
             // Type compatibility check
             if (AreTypesCompatible(var->type, potential_operand_symbol->type) || var->type == VOID_TYPE)
             {
-                fprintf(stdout, "MOVE LF@%s LF@%s\n", var->name, potential_operand->attribute);
+                fprintf(stdout, "MOVE LF@%s LF@%.*s\n", var->name, potential_operand->length, potential_operand->attribute);
                 var->type = potential_operand_symbol->type;
                 var->defined = true;
                 return;
@@ -1079,8 +1086,8 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
 
         // Syntax error
         default:
-            PrintError("Error in syntax analysis: Line %d: Unexpected token \"%s\" in assignment to variable",
-                       parser->line_number, potential_operand->attribute);
+            PrintError("Error in syntax analysis: Line %d: Unexpected token \"%.*s\" in assignment to variable",
+                       parser->line_number, potential_operand->length, potential_operand->attribute);
             CLEANUP
             exit(ERROR_SYNTACTIC);
         }
@@ -1091,14 +1098,15 @@ void VariableAssignment(Parser *parser, VariableSymbol *var, bool is_underscore)
         // Case 2, move the stream back and parse the expression
         stream_index -= 2;
 
+        // A constant remembers the value its initializer folds to
         TokenVector *postfix = InfixToPostfix(parser);
-        DATA_TYPE expr_type = ParseExpression(postfix, parser);
+        DATA_TYPE expr_type = ParseExpression(postfix, parser, !is_underscore && var->is_const ? var : NULL);
 
         if (!is_underscore && !AreTypesCompatible(var->type, expr_type) && var->type != VOID_TYPE)
         {
             PrintError("Error in semantic analysis: Line %d: Assigning invalid type to variable \"%s\", expected %d, got %d",
                        parser->line_number, var->name, var->type, expr_type);
-            DestroyTokenVector(stream);
+            DestroyStream();
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
             exit(ERROR_SEMANTIC_TYPE_COMPATIBILITY);
@@ -1145,7 +1153,7 @@ void FunctionToVariable(Parser *parser, VariableSymbol *var, FunctionSymbol *fun
         {
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_SEMANTIC_TYPE_COMPATIBILITY, "Line %d: Assigning return value of void function to variable.", parser->line_number);
         }
 
@@ -1163,7 +1171,7 @@ void FunctionToVariable(Parser *parser, VariableSymbol *var, FunctionSymbol *fun
         )
         {
             SymtableStackDestroy(parser->symtable_stack);
-            DestroyTokenVector(stream);
+            DestroyStream();
             DestroySymtable(parser->global_symtable);
             ErrorExit(ERROR_SEMANTIC_TYPE_COMPATIBILITY, "Line %d: Invalid type in assigning to variable");
         }
@@ -1202,7 +1210,7 @@ void ProgramBody(Parser *parser)
             {
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 ErrorExit(ERROR_SYNTACTIC, "Expected 'pub' keyword at line %d", parser->line_number);
             }
         }
@@ -1242,10 +1250,10 @@ void ProgramBody(Parser *parser)
             }
             else
             {
-                PrintError("Unexpected token \"%s\" at line %d", token->attribute, parser->line_number);
+                PrintError("Unexpected token \"%.*s\" at line %d", token->length, token->attribute, parser->line_number);
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 exit(ERROR_SYNTACTIC);
             }
             break;
@@ -1253,12 +1261,11 @@ void ProgramBody(Parser *parser)
         case R_CURLY_BRACKET:
             --(parser->nested_level);
             SymtableStackRemoveTop(parser);
-            parser->symtable = SymtableStackTop(parser->symtable_stack);
             return;
 
         case IDENTIFIER_TOKEN:
             // Can be a embedded function, or a defined function, or a called function, or a reassignment to a variable
-            if (!strcmp(token->attribute, "ifj"))
+            if (SYMBOL_IDS_EQUAL(token->symbol_id, ifj_symbol_id))
             {
                 func = IsEmbeddedFunction(parser);
                 stream_index += 2;                        // skip the 'ifj' and the '.' token
@@ -1268,8 +1275,8 @@ void ProgramBody(Parser *parser)
             else if ((var = IsVariableAssignment(token, parser)) != NULL)
             {
                 // Move past the ID =
-                token = GetNextToken(parser);
-                token = GetNextToken(parser);
+                GetNextTokenType(parser);
+                GetNextTokenType(parser);
 
                 // Variable assignment
                 VariableAssignment(parser, var, false);
@@ -1278,21 +1285,21 @@ void ProgramBody(Parser *parser)
             else if (IsFunctionCall(parser))
             {
                 // Store the function name in a temporary variable since we will be moving the tokens forward
-                char *tmp_func_name = strdup(token->attribute);
+                char *tmp_func_name = AttributeToString(token);
 
                 // Move past the ID(
                 stream_index += 2;
 
                 // Function call
-                FunctionCall(parser, FindFunctionSymbol(parser->global_symtable, tmp_func_name), tmp_func_name, VOID_TYPE);
+                FunctionCall(parser, FindFunctionSymbol(parser->global_symtable, token->symbol_id), tmp_func_name, VOID_TYPE);
                 free(tmp_func_name);
             }
 
             // Check for an undefinded variable case
-            else if(!SymtableStackFindVariable(parser->symtable_stack, token->attribute))
+            else if(!SymtableStackFindVariable(parser->symtable_stack, token->symbol_id))
             {
-                PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"",
-                           parser->line_number, token->attribute);
+                PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"",
+                           parser->line_number, token->length, token->attribute);
                 CLEANUP
                 exit(ERROR_SEMANTIC_UNDEFINED);
             }
@@ -1309,7 +1316,7 @@ void ProgramBody(Parser *parser)
             {
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 ErrorExit(ERROR_SYNTACTIC, "Unexpected end of file");
             }
 
@@ -1319,33 +1326,76 @@ void ProgramBody(Parser *parser)
             break; // Shut up gcc
 
         default:
-            PrintError("Unexpected token \"%s\" at line %d", token->attribute, parser->line_number);
+            PrintError("Unexpected token \"%.*s\" at line %d", token->length, token->attribute, parser->line_number);
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             exit(ERROR_SYNTACTIC);
         }
     }
 }
 
-void PrintEqualTokens()
+// Value of the option at argv[*i], either glued to it (-j4) or the next argument (-j 4), exits if there's none
+static const char *OptionValue(int argc, char **argv, int *i)
 {
-    for (int i = 0; i < stream->length; i++)
+    if (argv[*i][2] != '\0')
+        return argv[*i] + 2;
+
+    if (*i + 1 == argc)
+        ErrorExit(ERROR_INTERNAL, "Usage: ifj24 [-j threads] [-e precedence|table] [file]: missing value of %s", argv[*i]);
+
+    return argv[++(*i)];
+}
+
+#ifdef IFJ24_STATS
+// Prints all the statistics when the compiler exits, after a successful compilation or an error
+static void PrintStats(void)
+{
+    PrintSymtableStats();
+    PrintInternerStats();
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    // -j N (or -jN) scans the program on N threads (0 = one per CPU), -e precedence/table picks the expression parser,
+    // any other argument is the file to compile
+    const char *path = NULL;
+#ifdef IFJ24_STATS
+    atexit(PrintStats);
+#endif
+
+    for (int i = 1; i < argc; i++)
     {
-        for (int j = i + 1; j < stream->length; j++)
+        if (strncmp(argv[i], "-j", 2) == 0)
         {
-            if (i != j && stream->token_string[i] == stream->token_string[j])
-            {
-                fprintf(stderr, "Equal tokens found at indexes %d and %d\n", i, j);
-                PrintToken(stream->token_string[i]);
-                PrintToken(stream->token_string[j]);
-            }
+            const char *value = OptionValue(argc, argv, &i);
+            char *end;
+            errno = 0;
+            long threads = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || errno != 0 || threads < 0 || threads > PARALLEL_SCAN_MAX_THREADS)
+                ErrorExit(ERROR_INTERNAL, "Usage: ifj24 [-j threads] [-e precedence|table] [file]: -j expects 0 to %d, got \"%s\"",
+                          PARALLEL_SCAN_MAX_THREADS, value);
+
+            SetScanThreads((int)threads);
+        }
+        else if (strncmp(argv[i], "-e", 2) == 0)
+        {
+            const char *engine = OptionValue(argc, argv, &i);
+            if (strcmp(engine, "precedence") == 0)
+                SetExpressionEngine(PRECEDENCE_ENGINE);
+            else if (strcmp(engine, "table") == 0)
+                SetExpressionEngine(TABLE_ENGINE);
+            else
+                ErrorExit(ERROR_INTERNAL, "Usage: ifj24 [-j threads] [-e precedence|table] [file]: unknown expression engine \"%s\"", engine);
         }
+        else
+            path = argv[i];
     }
-}
 
-int main()
-{
+    // Load the program, either from the file given as an argument or from stdin
+    LoadSource(path);
+
     // parser instance
     Parser parser = InitParser();
 
@@ -1362,7 +1412,8 @@ int main()
     {
         SymtableStackDestroy(parser.symtable_stack);
         DestroySymtable(parser.global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
+        DestroySource();
         ErrorExit(ERROR_SEMANTIC_UNDEFINED, "Main function not found");
     }
 
@@ -1371,6 +1422,9 @@ int main()
 
     SymtableStackDestroy(parser.symtable_stack);
     DestroySymtable(parser.global_symtable);
-    DestroyTokenVector(stream);
+    DestroyStream();
+    DestroySource();
+    ReleaseSpareStacks();
+
     return 0;
 }
@@ -23,7 +23,7 @@
     {                                                                                                                 \
         PrintError("Error in semantic analysis: Line %d: Invalid parameter type for function call for function '%s'", \
                    parser->line_number, func->name);                                                                  \
-        DestroyTokenVector(stream);                                                                                   \
+        DestroyStream();                                                                                               \
         SymtableStackDestroy(parser->symtable_stack);                                                                 \
         DestroySymtable(parser->global_symtable);                                                                     \
         exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);                                                                      \
@@ -35,7 +35,7 @@
     {                                                                                                         \
         PrintError("Error in semantic analysis: Line %d: Invalid parameter count when calling function '%s'", \
                    parser->line_number, func->name);                                                          \
-        DestroyTokenVector(stream);                                                                           \
+        DestroyStream();                                                                                       \
         SymtableStackDestroy(parser->symtable_stack);                                                         \
         DestroySymtable(parser->global_symtable);                                                             \
         exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);                                                              \
@@ -45,9 +45,9 @@
 #define INVALID_PARAM_TOKEN                                                                          \
     do                                                                                               \
     {                                                                                                \
-        PrintError("Error in syntactic analysis: Line %d: Unexpected token \"%s\" in function call", \
-                   parser->line_number, token->attribute);                                           \
-        DestroyTokenVector(stream);                                                                  \
+        PrintError("Error in syntactic analysis: Line %d: Unexpected token \"%.*s\" in function call", \
+                   parser->line_number, token->length, token->attribute);                            \
+        DestroyStream();                                                                              \
         SymtableStackDestroy(parser->symtable_stack);                                                \
         DestroySymtable(parser->global_symtable);                                                    \
         exit(ERROR_SYNTACTIC);                                                                       \
@@ -57,7 +57,7 @@
 #define CLEANUP                                       \
     do                                                \
     {                                                 \
-        DestroyTokenVector(stream);                   \
+        DestroyStream();                               \
         SymtableStackDestroy(parser->symtable_stack); \
         DestroySymtable(parser->global_symtable);     \
     } while (0);
@@ -72,10 +72,14 @@ Parser InitParser();
 /**
  * @brief Gets the next token from the stream vector which is already loaded.
  *
- * @return Token*
+ * @return Token* A new token built from the stream (see StreamToken())
  */
 Token *GetNextToken(Parser *parser);
 
+// Variants of GetNextToken for when only the type/keyword type of the next token is needed, they don't create a Token
+TOKEN_TYPE GetNextTokenType(Parser *parser);
+KEYWORD_TYPE GetNextKeywordType(Parser *parser);
+
 /**
  * @brief Also exists for the sole purpose of removing some bloat from main.
  */
@@ -26,6 +26,22 @@
 #include "vector.h"
 #include "codegen.h"
 #include "scanner.h"
+#include "interner.h"
+
+// Interned ids of the embedded function names, in the order of embedded_names
+static int embedded_ids[EMBEDDED_FUNCTION_COUNT];
+
+// Index of the embedded function with the given name id in the embedded_ tables, -1 if it isn't one
+static int EmbeddedFunctionIndex(int symbol_id)
+{
+    for (int i = 0; i < EMBEDDED_FUNCTION_COUNT; i++)
+    {
+        if (SYMBOL_IDS_EQUAL(symbol_id, embedded_ids[i]))
+            return i;
+    }
+
+    return -1;
+}
 
 // ifj.function(params)
 FunctionSymbol *IsEmbeddedFunction(Parser *parser)
@@ -37,7 +53,7 @@ FunctionSymbol *IsEmbeddedFunction(Parser *parser)
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SEMANTIC_UNDEFINED, "Line %d: Undefined variable \"ifj\"");
     }
 
@@ -46,24 +62,21 @@ FunctionSymbol *IsEmbeddedFunction(Parser *parser)
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, "Line %d: Expected a embedded function name following \"ifj.\"");
     }
 
     // Check if it matches a IFJ function first, the user can also type in ifj.myFoo which would be an error
-    for (int i = 0; i < EMBEDDED_FUNCTION_COUNT; i++)
+    if (EmbeddedFunctionIndex(token->symbol_id) != -1)
     {
-        if (!strcmp(embedded_names[i], token->attribute)) // Match found
-        {
-            FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, token->attribute);
-            stream_index -= 2; // Move the stream back to the beginning of the embedded function
-            return func;
-        }
+        FunctionSymbol *func = FindFunctionSymbol(parser->global_symtable, token->symbol_id);
+        stream_index -= 2; // Move the stream back to the beginning of the embedded function
+        return func;
     }
 
     // The identifier was not an embedded function
-    PrintError("Error in semantic analysis: Line %d: Invalid embedded function name \"%s\"", parser->line_number, token->attribute);
-    DestroyTokenVector(stream);
+    PrintError("Error in semantic analysis: Line %d: Invalid embedded function name \"%.*s\"", parser->line_number, token->length, token->attribute);
+    DestroyStream();
     SymtableStackDestroy(parser->symtable_stack);
     DestroySymtable(parser->global_symtable);
     exit(ERROR_SEMANTIC_UNDEFINED);
@@ -75,25 +88,28 @@ void InsertEmbeddedFunctions(Parser *parser)
     {
         // Create a new function symbol
         FunctionSymbol *func = FunctionSymbolInit();
-        func->name = strdup(embedded_names[i]);
+        func->symbol_id = embedded_ids[i] = InternString(embedded_names[i], strlen(embedded_names[i]));
+        func->name = InternedName(func->symbol_id);
         func->return_type = embedded_return_types[i];
 
-        // Create the function's parameters
-        for (int j = 0; j < MAXPARAM_EMBEDDED_FUNCTION && embedded_parameters[i][j] != VOID_TYPE; j++)
+        // The parameter count is known from the table, so the array is allocated only once
+        int param_count = 0;
+        while (param_count < MAXPARAM_EMBEDDED_FUNCTION && embedded_parameters[i][param_count] != VOID_TYPE)
+            param_count++;
+
+        if (param_count != 0 && (func->parameters = malloc(sizeof(VariableSymbol *) * param_count)) == NULL)
+        {
+            SymtableStackDestroy(parser->symtable_stack);
+            DestroySymtable(parser->global_symtable);
+            DestroyStream();
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
+
+        // Create the function's parameters according to the table
+        for (int j = 0; j < param_count; j++)
         {
-            // Create a parameter according to the table
             VariableSymbol *param = VariableSymbolInit();
             param->type = embedded_parameters[i][j];
-
-            // Insert the new parameter into the function
-            if ((func->parameters = realloc(func->parameters, sizeof(VariableSymbol *) * (func->num_of_parameters + 1))) == NULL)
-            {
-                SymtableStackDestroy(parser->symtable_stack);
-                DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
-                ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-            }
-
             func->parameters[func->num_of_parameters++] = param;
         }
 
@@ -103,7 +119,7 @@ void InsertEmbeddedFunctions(Parser *parser)
             // This condition should never be false, but just in case put this here
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_INTERNAL, "Multiple instances of embedded function in the global symtable. Fix your code!!!");
         }
     }
@@ -131,12 +147,12 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
         case IDENTIFIER_TOKEN:
 
             // Undefined variable case
-            if ((var = SymtableStackFindVariable(parser->symtable_stack, token->attribute)) == NULL)
+            if ((var = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id)) == NULL)
             {
-                fprintf(stderr, "Undefined variable \"%s\"\n", token->attribute);
-                PrintError("Error in syntax analysis: Line %d: Undefined variable \"%s\"", parser->line_number, token->attribute);
+                fprintf(stderr, "Undefined variable \"%.*s\"\n", token->length, token->attribute);
+                PrintError("Error in syntax analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, token->length, token->attribute);
                 DestroyTokenVector(operands);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 exit(ERROR_SEMANTIC_UNDEFINED);
@@ -148,7 +164,7 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
                 PrintError("Error in semantic analysis: Line %d: Incompatible types in parameter %d of function call \"%s\"", parser->line_number, loaded + 1, func->name);
                 fprintf(stderr, "Expected type %d, got %d\n", func->parameters[loaded]->type, var->type);
                 DestroyTokenVector(operands);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
@@ -166,7 +182,7 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
             {
                 PrintError("Error in semantic analysis: Line %d: Incompatible types in parameter %d of function call \"%s\"", parser->line_number, loaded + 1, func->name);
                 DestroyTokenVector(operands);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
@@ -184,7 +200,7 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
             {
                 PrintError("Error in semantic analysis: Line %d: Incompatible types in parameter %d of function call \"%s\"", parser->line_number, loaded + 1, func->name);
                 DestroyTokenVector(operands);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
@@ -202,7 +218,7 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
             {
                 PrintError("Error in semantic analysis: Line %d: Incompatible types in parameter %d of function call \"%s\"", parser->line_number, loaded + 1, func->name);
                 DestroyTokenVector(operands);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
@@ -215,9 +231,9 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
 
         // Invalid/unexpected token
         default:
-            PrintError("Error in syntax analysis: Line %d: Unexpected token \"%s\" in function call \"%s\"", parser->line_number, token->attribute, func->name);
+            PrintError("Error in syntax analysis: Line %d: Unexpected token \"%.*s\" in function call \"%s\"", parser->line_number, token->length, token->attribute, func->name);
             DestroyTokenVector(operands);
-            DestroyTokenVector(stream);
+            DestroyStream();
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
             exit(ERROR_SYNTACTIC);
@@ -228,7 +244,7 @@ TokenVector *ParseEmbeddedFunctionParams(Parser *parser, FunctionSymbol *func)
         {
             PrintError("Error in semantic analysis: Line %d: Invalid parameter count when calling function '%s': Expected %d, got %d", parser->line_number, func->name, func->num_of_parameters, loaded);
             DestroyTokenVector(operands);
-            DestroyTokenVector(stream);
+            DestroyStream();
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
             exit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION);
@@ -264,45 +280,61 @@ void EmbeddedFunctionCall(Parser *parser, FunctionSymbol *func, VariableSymbol *
     CheckTokenTypeVector(parser, SEMICOLON);
 
     // Now we can generate the code depending on the function
-    if (!strcmp(func->name, "readi32"))
+    switch (EmbeddedFunctionIndex(func->symbol_id))
+    {
+    case EMBEDDED_READI32:
         READ(var, LOCAL_FRAME, INT32_TYPE);
+        break;
 
-    else if (!strcmp(func->name, "readf64"))
+    case EMBEDDED_READF64:
         READ(var, LOCAL_FRAME, DOUBLE64_TYPE);
+        break;
 
-    else if (!strcmp(func->name, "readstr"))
+    case EMBEDDED_READSTR:
         READ(var, LOCAL_FRAME, U8_ARRAY_TYPE);
+        break;
 
-    else if (!strcmp(func->name, "write"))
+    case EMBEDDED_WRITE:
         WRITEINSTRUCTION(params->token_string[0], LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "i2f"))
+    case EMBEDDED_I2F:
         INT2FLOAT(var, params->token_string[0], LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "f2i"))
+    case EMBEDDED_F2I:
         FLOAT2INT(var, params->token_string[0], LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "length"))
+    case EMBEDDED_LENGTH:
         STRLEN(var, params->token_string[0], LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "concat"))
+    case EMBEDDED_CONCAT:
         CONCAT(var, params->token_string[0], params->token_string[1], LOCAL_FRAME, LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "strcmp"))
+    case EMBEDDED_STRCMP:
         STRCMP(var, params->token_string[0], params->token_string[1], LOCAL_FRAME, LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "string"))
+    case EMBEDDED_STRING:
         STRING(var, params->token_string[0], LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "ord"))
+    case EMBEDDED_ORD:
         ORD(var, params->token_string[0], params->token_string[1], LOCAL_FRAME, LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
-    else if (!strcmp(func->name, "chr"))
+    case EMBEDDED_CHR:
         INT2CHAR(var, params->token_string[0], LOCAL_FRAME, LOCAL_FRAME);
+        break;
 
     // This is by far the most complicated out of these :(
-    else if (!strcmp(func->name, "substring"))
+    case EMBEDDED_SUBSTRING:
         SUBSTRING(var, params->token_string[0], params->token_string[1], params->token_string[2], LOCAL_FRAME, LOCAL_FRAME, LOCAL_FRAME, LOCAL_FRAME);
+        break;
+    }
 
     DestroyTokenVector(params);
 }
\ No newline at end of file
@@ -41,6 +41,13 @@ const PrecedenceTable precedence_table = {
     /*)*/ {INVALID, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, REDUCE, INVALID, REDUCE, REDUCE},
     /*$*/ {SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, SHIFT, INVALID, ACCEPT}};
 
+static EXPRESSION_ENGINE expression_engine = DEFAULT_EXPRESSION_ENGINE;
+
+void SetExpressionEngine(EXPRESSION_ENGINE engine)
+{
+    expression_engine = engine;
+}
+
 PtableKey GetPtableKey(Token *token, int bracket_count)
 {
     // The only time this will happen is with the initial terminal dollar
@@ -145,9 +152,9 @@ EXPRESSION_RULE FindRule(ExpressionStack *stack, int distance)
     {
         if (top->token->token_type != R_ROUND_BRACKET)
             return NOT_FOUND_RULE;
-        if (top->next->node_type != NONTERMINAL)
+        if (ExpressionStackPeek(stack, 1)->node_type != NONTERMINAL)
             return NOT_FOUND_RULE;
-        if (top->next->next->node_type != TERMINAL && top->next->next->token->token_type != L_ROUND_BRACKET)
+        if (ExpressionStackPeek(stack, 2)->node_type != TERMINAL && ExpressionStackPeek(stack, 2)->token->token_type != L_ROUND_BRACKET)
             return NOT_FOUND_RULE;
 
         return BRACKET_RULE;
@@ -161,9 +168,10 @@ EXPRESSION_RULE FindRule(ExpressionStack *stack, int distance)
         return NOT_FOUND_RULE;
 
     // OPERATOR
-    if (top->next->node_type != TERMINAL)
+    ExpressionStackNode *operator= ExpressionStackPeek(stack, 1);
+    if (operator->node_type != TERMINAL)
         return NOT_FOUND_RULE;
-    switch (top->next->token->token_type)
+    switch (operator->token->token_type)
     {
     case MULTIPLICATION_OPERATOR:
         rule = MULTIPLICATION_RULE;
@@ -210,7 +218,7 @@ EXPRESSION_RULE FindRule(ExpressionStack *stack, int distance)
     }
 
     // E
-    if (top->next->next->node_type != NONTERMINAL)
+    if (ExpressionStackPeek(stack, 2)->node_type != NONTERMINAL)
         return NOT_FOUND_RULE;
 
     return rule;
@@ -228,7 +236,7 @@ void ReduceToNonterminal(ExpressionStack *stack, TokenVector *postfix, EXPRESSIO
     {
     case IDENTIFIER_RULE:
         // E -> id
-        AppendToken(postfix, CopyToken(ExpressionStackTop(stack)->token));
+        AppendToken(postfix, ExpressionStackTop(stack)->token);
         ExpressionStackRemoveTop(stack);
 
         // Remove the handle from the stack
@@ -263,9 +271,7 @@ void ReduceToNonterminal(ExpressionStack *stack, TokenVector *postfix, EXPRESSIO
         ExpressionStackRemoveTop(stack);                          // Second nonterminal
         ExpressionStackRemoveTop(stack);                          // Handle
 
-        AppendToken(postfix, CopyToken(operator->token)); // Append the operator to the postfix string
-
-        free(operator); // Destroy excess nodes
+        AppendToken(postfix, operator->token); // Append the operator to the postfix string (before anything is pushed over its node)
 
         break;
 
@@ -275,51 +281,62 @@ void ReduceToNonterminal(ExpressionStack *stack, TokenVector *postfix, EXPRESSIO
     }
 
     // Push the nonterminal to the stack
-    ExpressionStackNode *nonterminal = ExpressionStackNodeInit(NULL, NONTERMINAL, PTABLE_NOKEY);
-    ExpressionStackPush(stack, nonterminal);
+    ExpressionStackPush(stack, NULL, NONTERMINAL, PTABLE_NOKEY);
 
     return;
 }
 
+// Exits with a syntax error if the expression starting at the next token is empty, the stream stays at its start
+static void CheckExpressionNotEmpty(Parser *parser)
+{
+    TOKEN_TYPE first = GetNextTokenType(parser);
+    if (first == SEMICOLON || first == R_ROUND_BRACKET)
+    {
+        PrintError("Error in syntactic analysis: Line %d: Empty expression", parser->line_number);
+        CLEANUP
+        exit(ERROR_SYNTACTIC);
+    }
+
+    --(stream_index); // Move the stream back to the beginning of the expression
+}
+
 TokenVector *InfixToPostfix(Parser *parser)
 {
+    if (expression_engine == PRECEDENCE_ENGINE)
+        return PrecedenceToPostfix(parser);
+
+    // Check if the expression isn't empty
+    CheckExpressionNotEmpty(parser);
+
     // needed structures/varibles
     ExpressionStack *stack = ExpressionStackInit(); // Stack for precedence analysis
     TokenVector *postfix = InitTokenVector();       // Output postfix vector
-    ExpressionStackNode *node;                      // Temporary node for pushing to the stack
     Token *token;                                   // Input token
     EXPRESSION_RULE rule = NOT_FOUND_RULE;          // Rule to be applied
     PtableKey key = PTABLE_NOKEY;                   // Key for indexing into the precedence table
     int bracket_count = 0;                          // In case the expression ends
     int distance = -1;                              // Distance to the handle
     bool expression_over = false;                   // If the expression is over, set to true after accepting the last token
-
-    // Check if the expression isn't empty
-    Token *first = GetNextToken(parser);
-    if (first->token_type == SEMICOLON || first->token_type == R_ROUND_BRACKET)
-    {
-        PrintError("Error in syntactic analysis: Line %d: Empty expression", parser->line_number);
-        CLEANUP
-        exit(ERROR_SYNTACTIC);
-    }
-
-    --(stream_index); // Move the stream back to the beginning of the expression
+    bool reread = false;                            // After a reduction the same input token is looked at again
 
     // Initial dollar sign
-    ExpressionStackNode *beginning = ExpressionStackNodeInit(NULL, TERMINAL, PTABLE_DOLLAR);
-    ExpressionStackPush(stack, beginning);
+    ExpressionStackPush(stack, NULL, TERMINAL, PTABLE_DOLLAR);
 
     while (true)
     {
-        // Get the next token from the input if we aren't at the end of the expression, else it stays the same
-        if (!expression_over)
-            token = CopyToken(GetNextToken(parser));
+        // Get the next token from the input if we aren't at the end of the expression or reducing, else it stays the same
+        if (!expression_over && !reread)
+        {
+            token = GetNextToken(parser);
 
-        // Update the bracket count if needed
-        if (token->token_type == L_ROUND_BRACKET && !expression_over)
-            bracket_count++;
-        else if (token->token_type == R_ROUND_BRACKET && !expression_over)
-            bracket_count--;
+            // Update the bracket count if needed
+            if (token->token_type == L_ROUND_BRACKET)
+                bracket_count++;
+            else if (token->token_type == R_ROUND_BRACKET)
+                bracket_count--;
+        }
+
+        reread = false;
 
         // Get the topmost terminal symbol from the stack and the token's key to index
         ExpressionStackNode *topmost = TopmostTerminal(stack);
@@ -328,9 +345,8 @@ TokenVector *InfixToPostfix(Parser *parser)
         // Check for a invalid token
         if (key == PTABLE_ERROR)
         {
-            PrintError("Error in syntactic analysis: Line %d: Unexpected token \"%s\" in expression", parser->line_number, token->attribute);
+            PrintError("Error in syntactic analysis: Line %d: Unexpected token \"%.*s\" in expression", parser->line_number, token->length, token->attribute);
             DestroyExpressionStackAndVector(postfix, stack);
-            DestroyToken(token);
             CLEANUP
             exit(ERROR_SYNTACTIC);
         }
@@ -345,32 +361,21 @@ TokenVector *InfixToPostfix(Parser *parser)
         {
         // Push the input token to the stack and move on to the next iteration
         case MATCH:
-            node = ExpressionStackNodeInit(token, TERMINAL, GetPtableKey(token, 1)); // TODO: check if this hard-coded 1 is correct
-            ExpressionStackPush(stack, node);
+            ExpressionStackPush(stack, token, TERMINAL, GetPtableKey(token, 1)); // TODO: check if this hard-coded 1 is correct
             break;
 
         // Put a handle after the topmost terminal and push the input token to the stack
         case SHIFT:
             PushHandleAfterTopmost(stack);
-            node = ExpressionStackNodeInit(token, TERMINAL, GetPtableKey(token, 1));
-            ExpressionStackPush(stack, node);
+            ExpressionStackPush(stack, token, TERMINAL, GetPtableKey(token, 1));
             break;
 
         // Reduce the stack (so find a rule)
         case REDUCE:
-            // Revert some actions depending on the input token since we will read it again anyway
-            if (!expression_over)
-                (--stream_index);
-            if (token->token_type == R_ROUND_BRACKET && !expression_over)
-                bracket_count++;
-            if (token->token_type == L_ROUND_BRACKET && !expression_over)
-                bracket_count--;
+            // The input token isn't consumed, it's compared with the new topmost terminal in the next iteration
+            reread = true;
             distance = TopmostHandleDistance(stack);
 
-            // Destroy the copy
-            if (!expression_over)
-                DestroyToken(token);
-
             // We have to reduce the nodes between the handle and the stack top
             rule = FindRule(stack, distance);
 
@@ -380,7 +385,6 @@ TokenVector *InfixToPostfix(Parser *parser)
                 fprintf(stderr, "Invalid expression, rule not found\n");
                 PrintError("Error in syntactic analysis: Line %d: Invalid expression", parser->line_number);
                 DestroyExpressionStackAndVector(postfix, stack);
-                DestroyToken(token);
                 CLEANUP
                 exit(ERROR_SYNTACTIC);
             }
@@ -395,60 +399,144 @@ TokenVector *InfixToPostfix(Parser *parser)
             fprintf(stderr, "Invalid expression\n");
             PrintError("Error in syntactic analysis: Line %d: Invalid expression", parser->line_number);
             DestroyExpressionStackAndVector(postfix, stack);
-            DestroyToken(token);
             CLEANUP
             exit(ERROR_SYNTACTIC);
 
         // End of the expression
         case ACCEPT:
-            AppendToken(postfix, CopyToken(token));
+            AppendToken(postfix, token);
             ExpressionStackDestroy(stack);
             return postfix;
         }
     }
 }
 
-bool IsTokenInString(TokenVector *postfix, Token *token)
+// Binding power of a binary operator (the higher, the tighter it binds), 0 for any other key
+static int BindingPower(PtableKey key)
 {
-    if (token == NULL)
-        return false;
-    for (int i = 0; i < postfix->length; i++)
+    switch (key)
     {
-        if (token == postfix->token_string[i])
-            return true;
-    }
+    case PTABLE_MULTIPLICATION:
+    case PTABLE_DIVISION:
+        return 3;
+
+    case PTABLE_ADDITION:
+    case PTABLE_SUBSTRACTION:
+        return 2;
+
+    case PTABLE_EQUAL:
+    case PTABLE_NOT_EQUAL:
+    case PTABLE_LESS_THAN:
+    case PTABLE_LARGER_THAN:
+    case PTABLE_LESSER_EQUAL:
+    case PTABLE_LARGER_EQUAL:
+        return 1;
 
-    return false;
+    default:
+        return 0;
+    }
 }
 
-void DestroyExpressionStackAndVector(TokenVector *postfix, ExpressionStack *stack)
+TokenVector *PrecedenceToPostfix(Parser *parser)
 {
-    while (stack->size != 0)
+    CheckExpressionNotEmpty(parser);
+
+    ExpressionStack *operators = ExpressionStackInit(); // Operators waiting for their right operand and the open brackets
+    TokenVector *postfix = InitTokenVector();           // Output postfix vector
+    int bracket_count = 0;                              // The same as in InfixToPostfix(), a ')' below 0 ends the expression
+    bool expect_operand = true;                         // An operand or '(' comes next, else an operator, ')' or the end
+
+    while (true)
     {
-        ExpressionStackNode *top = ExpressionStackPop(stack);
-        if (top->token != NULL && !IsTokenInString(postfix, top->token))
+        Token *token = GetNextToken(parser);
+        if (token->token_type == L_ROUND_BRACKET)
+            bracket_count++;
+        else if (token->token_type == R_ROUND_BRACKET)
+            bracket_count--;
+
+        PtableKey key = GetPtableKey(token, bracket_count);
+        if (key == PTABLE_ERROR)
+        {
+            PrintError("Error in syntactic analysis: Line %d: Unexpected token \"%.*s\" in expression", parser->line_number, token->length, token->attribute);
+            DestroyExpressionStackAndVector(postfix, operators);
+            CLEANUP
+            exit(ERROR_SYNTACTIC);
+        }
+
+        int power = BindingPower(key);
+        bool valid = expect_operand ? key == PTABLE_ID || key == PTABLE_LEFT_BRACKET
+                                    : power != 0 || key == PTABLE_RIGHT_BRACKET || key == PTABLE_DOLLAR;
+        if (!valid)
+        {
+            PrintError("Error in syntactic analysis: Line %d: Invalid expression", parser->line_number);
+            DestroyExpressionStackAndVector(postfix, operators);
+            CLEANUP
+            exit(ERROR_SYNTACTIC);
+        }
+
+        // Operands are already in their place in the postfix, brackets wait for their pair on the stack
+        if (key == PTABLE_ID)
+        {
+            AppendToken(postfix, token);
+            expect_operand = false;
+            continue;
+        }
+
+        if (key == PTABLE_LEFT_BRACKET)
+        {
+            ExpressionStackPush(operators, token, TERMINAL, key);
+            continue;
+        }
+
+        // The operators which bind at least as tight as this one have both operands now, ')' and the end take all of them
+        ExpressionStackNode *top;
+        while ((top = ExpressionStackTop(operators)) != NULL && top->key_type != PTABLE_LEFT_BRACKET && BindingPower(top->key_type) >= power)
+        {
+            AppendToken(postfix, top->token);
+            ExpressionStackRemoveTop(operators);
+        }
+
+        switch (key)
         {
-            DestroyToken(top->token);
-            top->token = NULL;
-            ExpressionStackRemoveTop(stack);
+        // The bracket's pair is on the top now, bracket_count doesn't let a ')' without one get here
+        case PTABLE_RIGHT_BRACKET:
+            ExpressionStackRemoveTop(operators);
+            break;
+
+        // End of the expression, which can't end inside brackets
+        case PTABLE_DOLLAR:
+            if (!ExpressionStackIsEmpty(operators))
+            {
+                PrintError("Error in syntactic analysis: Line %d: Invalid expression", parser->line_number);
+                DestroyExpressionStackAndVector(postfix, operators);
+                CLEANUP
+                exit(ERROR_SYNTACTIC);
+            }
+
+            AppendToken(postfix, token);
+            ExpressionStackDestroy(operators);
+            return postfix;
+
+        // Binary operator, waits for its right operand
+        default:
+            ExpressionStackPush(operators, token, TERMINAL, key);
+            expect_operand = true;
+            break;
         }
     }
+}
 
+void DestroyExpressionStackAndVector(TokenVector *postfix, ExpressionStack *stack)
+{
+    // The tokens themselves belong to the token arena, so only the containers are freed
     DestroyTokenVector(postfix);
     ExpressionStackDestroy(stack);
 }
 
-void DestroyEvaluationStackAndVector(TokenVector *postfix, EvaluationStack *stack)
+void DestroyExpressionTreeAndVector(TokenVector *postfix, ExpressionTree *tree)
 {
-    while (stack->size != 0)
-    {
-        Token *top = EvaluationStackPop(stack);
-        if (!IsTokenInString(postfix, top))
-            DestroyToken(top);
-    }
-
     DestroyTokenVector(postfix);
-    EvaluationStackDestroy(stack);
+    ExpressionTreeDestroy(tree);
 }
 
 void PrintPostfix(TokenVector *postfix)
@@ -461,52 +549,65 @@ void PrintPostfix(TokenVector *postfix)
 
     for (int i = 0; i < postfix->length; i++)
     {
-        fprintf(stderr, "%s", postfix->token_string[i]->attribute);
+        fprintf(stderr, "%.*s", postfix->token_string[i]->length, postfix->token_string[i]->attribute);
     }
 
     fprintf(stderr, "\n");
 }
 
-void ReplaceConstants(TokenVector *postfix, Parser *parser)
+void ResolveIdentifiers(TokenVector *postfix, Parser *parser)
+{
+    // the scopes can't change in the middle of an expression, so one lookup per identifier is enough
+    for (int i = 0; i < postfix->length; i++)
+    {
+        Token *token = postfix->token_string[i];
+        if (token->token_type == IDENTIFIER_TOKEN)
+            token->variable = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id);
+    }
+}
+
+void ReplaceConstants(TokenVector *postfix)
 {
     for (int i = 0; i < postfix->length; i++)
     {
         Token *token = postfix->token_string[i];
         if (token->token_type == IDENTIFIER_TOKEN)
         {
-            VariableSymbol *var = SymtableStackFindVariable(parser->symtable_stack, token->attribute);
-            if (var != NULL && !var->nullable && var->is_const && var->value != NULL && var->type == DOUBLE64_TYPE && HasZeroDecimalPlaces(var->value))
+            VariableSymbol *var = token->variable;
+            if (var != NULL && !var->nullable && var->is_const && var->value != NULL && var->type == DOUBLE64_TYPE && HasZeroDecimalPlaces(var->const_value.floating))
             {
                 var->was_used = true;
-                Token *new = InitToken();
-                new->attribute = strdup(var->value);
-                new->line_number = token->line_number;
+
+                // The postfix has its own token for every operand, so it's turned into the literal in place.
+                // The text is the variable's, which lives longer than the expression
+                *token = (Token){
+                    .keyword_type = NONE,
+                    .line_number = token->line_number,
+                    .attribute = var->value,
+                    .length = strlen(var->value),
+                    .value = var->const_value,
+                };
                 switch (var->type)
                 {
                 case INT32_TYPE:
-                    new->token_type = INTEGER_32;
+                    token->token_type = INTEGER_32;
                     break;
 
                 case DOUBLE64_TYPE:
-                    new->token_type = DOUBLE_64;
+                    token->token_type = DOUBLE_64;
                     break;
 
                 // Will never happen
                 default:
                     break;
                 }
-
-                // Replace the old token
-                postfix->token_string[i] = new;
-                DestroyToken(token);
             }
         }
     }
 }
 
-bool HasZeroDecimalPlaces(char *float_value)
+bool HasZeroDecimalPlaces(double val)
 {
-    double val = strtod(float_value, NULL);
     int int_part = (int)val;
 
     if (val - int_part < 0.0)
@@ -531,7 +632,7 @@ int CheckLiteralsCompatibilityArithmetic(Token *var_lhs, Token *var_rhs, Token *
     if (var_lhs->token_type != var_rhs->token_type)
     {
         Token *f_token = var_lhs->token_type == DOUBLE_64 ? var_lhs : var_rhs;
-        if (!HasZeroDecimalPlaces(f_token->attribute))
+        if (!HasZeroDecimalPlaces(f_token->value.floating))
         {
             PrintError("Error in semantic analysis: Line %d: Incompatible types in division operation", parser->line_number);
             return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
@@ -541,57 +642,6 @@ int CheckLiteralsCompatibilityArithmetic(Token *var_lhs, Token *var_rhs, Token *
     return 0;
 }
 
-DATA_TYPE ArithmeticOperationTwoLiterals(Token *operand_left, Token *operand_right, Token *operator)
-{
-    // Get the resulting type of the operation
-    DATA_TYPE result_type = operand_left->token_type == DOUBLE_64 ||
-                                    operand_right->token_type == DOUBLE_64
-                                ? DOUBLE64_TYPE
-                                : INT32_TYPE;
-
-    // If one operand is a double and the other is a float, we need to convert the int
-
-    // In this case, the right operand is on top of the stack so stack conversion will suffice
-    if (operand_right->token_type == INTEGER_32 && operand_left->token_type == DOUBLE_64)
-        INT2FLOATS
-
-    // In this case, the left operand is not on top of the stack so we need a temporary register for conversion
-    else if (operand_left->token_type == INTEGER_32 && operand_right->token_type == DOUBLE_64)
-    {
-        // Since the right operand is an int, we can temporarily store it in R0
-        PopToRegister(DOUBLE64_TYPE);
-
-        // The second operand is now on top of the stack
-        INT2FLOATS
-
-        // Push the first operand back from F0
-        fprintf(stdout, "PUSHS GF@$F0\n");
-    }
-
-    // Perform the operation based on the operator
-    switch (operator->token_type)
-    {
-    case MULTIPLICATION_OPERATOR:
-        MULS break;
-
-    case DIVISION_OPERATOR:
-        if (result_type == DOUBLE64_TYPE)
-            DIVS else IDIVS break;
-
-    case ADDITION_OPERATOR:
-        ADDS break;
-
-    case SUBSTRACTION_OPERATOR:
-        SUBS break;
-
-    // Will literally never ever happen
-    default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in OperationTwoLiterals");
-    }
-
-    return result_type;
-}
-
 int CheckLiteralVarCompatibilityArithmetic(Token *literal, Token *var, Token *operator, Parser * parser)
 {
     // The literal can't be NULL
@@ -602,17 +652,17 @@ int CheckLiteralVarCompatibilityArithmetic(Token *literal, Token *var, Token *op
     }
 
     // First check if var is defined
-    VariableSymbol *var_symbol = SymtableStackFindVariable(parser->symtable_stack, var->attribute);
+    VariableSymbol *var_symbol = var->variable;
     if (var_symbol == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var->length, var->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
     // Check if the variable is nullable
     else if (IsNullable(var_symbol->type))
     {
-        PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is nullable", parser->line_number, var->attribute);
+        PrintError("Error in semantic analysis: Line %d: Variable \"%.*s\" is nullable", parser->line_number, var->length, var->attribute);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
     }
 
@@ -627,7 +677,7 @@ int CheckLiteralVarCompatibilityArithmetic(Token *literal, Token *var, Token *op
         return 0; // case 1
     else if (literal->token_type == INTEGER_32 && var_symbol->type == DOUBLE64_TYPE && operator->token_type != DIVISION_OPERATOR)
         return 0; // case 2, later convert to float
-    else if (literal->token_type == DOUBLE_64 && HasZeroDecimalPlaces(literal->attribute) && var_symbol->type == INT32_TYPE)
+    else if (literal->token_type == DOUBLE_64 && HasZeroDecimalPlaces(literal->value.floating) && var_symbol->type == INT32_TYPE)
         return 0; // case 3, later convert to int
 
     // If none of the cases are met, the types are incompatible
@@ -635,109 +685,35 @@ int CheckLiteralVarCompatibilityArithmetic(Token *literal, Token *var, Token *op
     return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
 }
 
-DATA_TYPE ArithmeticOperationLiteralId(Token *literal, VariableSymbol *id, Token *operator, bool literal_on_top)
-{
-    // Get the resulting type of the operation
-    DATA_TYPE result_type = literal->token_type == DOUBLE_64 ||
-                                    id->type == DOUBLE64_TYPE
-                                ? DOUBLE64_TYPE
-                                : INT32_TYPE;
-
-    // Check if the literal isn't an int and the variable is a double, if yes convert the int
-    if (literal->token_type == INTEGER_32 && id->type == DOUBLE64_TYPE)
-    {
-        // If the literal is on top of the stack, we can convert it directly
-        if (literal_on_top)
-            INT2FLOATS
-
-        // The other case, we will need to use temporary variables, the variable is a double so we will temporarily store it in F0
-        else
-        {
-            // Store the variable in F0
-            PopToRegister(DOUBLE64_TYPE);
-
-            // Convert the literal to a float
-            INT2FLOATS
-
-            // Push the variable back
-            fprintf(stdout, "PUSHS GF@$F0\n");
-        }
-    }
-
-    // Do the same for floats
-    else if (literal->token_type == DOUBLE_64 && id->type == INT32_TYPE)
-    {
-        // If the literal is on top of the stack, we can convert it directly
-        if (literal_on_top)
-            FLOAT2INTS
-
-        // The other case, we will need to use temporary variables, the variable is an int so we will temporarily store it in R0
-        else
-        {
-            // Store the variable in R0
-            PopToRegister(INT32_TYPE);
-
-            // Convert the literal to an int
-            FLOAT2INTS
-
-            // Push the variable back
-            fprintf(stdout, "PUSHS GF@$R0\n");
-        }
-    }
-
-    // Perform the given operation
-    switch (operator->token_type)
-    {
-    case MULTIPLICATION_OPERATOR:
-        MULS break;
-
-    case DIVISION_OPERATOR:
-        if (result_type == DOUBLE64_TYPE)
-            DIVS else IDIVS break;
-
-    case ADDITION_OPERATOR:
-        ADDS break;
-
-    case SUBSTRACTION_OPERATOR:
-        SUBS break;
-
-    // Will literally never ever happen
-    default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in OperationLiteralId");
-    }
-
-    return result_type;
-}
-
 int CheckTwoVariablesCompatibilityArithmetic(Token *var_lhs, Token *var_rhs, Parser *parser)
 {
     // Get the corresponding variable symbols
-    VariableSymbol *lhs = SymtableStackFindVariable(parser->symtable_stack, var_lhs->attribute);
-    VariableSymbol *rhs = SymtableStackFindVariable(parser->symtable_stack, var_rhs->attribute);
+    VariableSymbol *lhs = var_lhs->variable;
+    VariableSymbol *rhs = var_rhs->variable;
 
     // Check if the variables are defined
     if (lhs == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var_lhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var_lhs->length, var_lhs->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
     if (rhs == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var_rhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var_rhs->length, var_rhs->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
     // Check if the variables are nullable
     if (IsNullable(lhs->type))
     {
-        PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is nullable", parser->line_number, var_lhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Variable \"%.*s\" is nullable", parser->line_number, var_lhs->length, var_lhs->attribute);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
     }
 
     if (IsNullable(rhs->type))
     {
-        PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is nullable", parser->line_number, var_rhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Variable \"%.*s\" is nullable", parser->line_number, var_rhs->length, var_rhs->attribute);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
     }
 
@@ -751,35 +727,6 @@ int CheckTwoVariablesCompatibilityArithmetic(Token *var_lhs, Token *var_rhs, Par
     return 0;
 }
 
-DATA_TYPE ArithmeticOperationTwoIds(VariableSymbol *operand_left, VariableSymbol *operand_right, Token *operator)
-{
-    // Get the resulting type (it doesn't matter which operand we check, we assured their types are equal)
-    DATA_TYPE result_type = operand_left->type == DOUBLE64_TYPE || operand_right->type == DOUBLE64_TYPE ? DOUBLE64_TYPE : INT32_TYPE;
-
-    // Perform the operation based on the operator
-    switch (operator->token_type)
-    {
-    case MULTIPLICATION_OPERATOR:
-        MULS break;
-
-    case DIVISION_OPERATOR:
-        if (result_type == DOUBLE64_TYPE)
-            DIVS else IDIVS break;
-
-    case ADDITION_OPERATOR:
-        ADDS break;
-
-    case SUBSTRACTION_OPERATOR:
-        SUBS break;
-
-    // Will literally never ever happen
-    default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in OperationTwoIds");
-    }
-
-    return result_type;
-}
-
 int CheckCompatibilityLiteralsBoolean(Token *literal_left, Token *literal_right, Token *operator, Parser * parser)
 {
     /* The literals are incompatible if, and only if these conditions are met:
@@ -806,64 +753,13 @@ int CheckCompatibilityLiteralsBoolean(Token *literal_left, Token *literal_right,
     return 0;
 }
 
-void BooleanOperationTwoLiterals(Token *operand_left, Token *operand_right, Token *operator)
-{
-    // If one of the operands is a double, we need to convert the int
-
-    // In this case, the right operand is on top of the stack so stack conversion will suffice
-    if (operand_left->token_type == DOUBLE_64 && operand_right->token_type == INTEGER_32)
-        INT2FLOATS
-
-    // In this case, the left operand is not on top of the stack so we need a temporary register for conversion
-    else if (operand_left->token_type == INTEGER_32 && operand_right->token_type == DOUBLE_64)
-    {
-        // Since the right operand is an int, we can temporarily store it in R0
-        PopToRegister(DOUBLE64_TYPE);
-
-        // The second operand is now on top of the stack
-        INT2FLOATS
-
-        // Push the first operand back from R0
-        fprintf(stdout, "PUSHS GF@$F0\n");
-    }
-
-    // Perform the operation based on the operator
-    switch (operator->token_type)
-    {
-    case EQUAL_OPERATOR:
-        EQS break;
-
-    case NOT_EQUAL_OPERATOR:
-        EQS
-            NOTS break;
-
-    case LESS_THAN_OPERATOR:
-        LTS break;
-
-    case LARGER_THAN_OPERATOR:
-        GTS break;
-
-    case LESSER_EQUAL_OPERATOR:
-        GTS
-            NOTS break;
-
-    case LARGER_EQUAL_OPERATOR:
-        LTS
-            NOTS break;
-
-    // Will literally never ever happen
-    default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in BooleanExpressionTwoLiterals");
-    }
-}
-
 int CheckLiteralVarCompatibilityBoolean(Token *literal, Token *var, Token *operator, Parser * parser)
 {
     // First check if var is defined
-    VariableSymbol *var_symbol = SymtableStackFindVariable(parser->symtable_stack, var->attribute);
+    VariableSymbol *var_symbol = var->variable;
     if (var_symbol == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var->length, var->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
@@ -882,7 +778,7 @@ int CheckLiteralVarCompatibilityBoolean(Token *literal, Token *var, Token *opera
 
         if (!IsNullable(var_symbol->type))
         {
-            PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is not nullable", parser->line_number, var->attribute);
+            PrintError("Error in semantic analysis: Line %d: Variable \"%.*s\" is not nullable", parser->line_number, var->length, var->attribute);
             return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
         }
     }
@@ -890,12 +786,12 @@ int CheckLiteralVarCompatibilityBoolean(Token *literal, Token *var, Token *opera
     // Nullable check (== and != accept nullables, but only if both operands are nullable)
     if (IsNullable(var_symbol->type) && (operator->token_type != EQUAL_OPERATOR && operator->token_type != NOT_EQUAL_OPERATOR))
     {
-        PrintError("Error in semantic analysis: Line %d: Comparing nullable variable \"%s\" with a constant", parser->line_number, var->attribute);
+        PrintError("Error in semantic analysis: Line %d: Comparing nullable variable \"%.*s\" with a constant", parser->line_number, var->length, var->attribute);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
     }
 
     // Double literal and int variable
-    else if (literal->token_type == DOUBLE_64 && var_symbol->type == INT32_TYPE && !HasZeroDecimalPlaces(literal->attribute))
+    else if (literal->token_type == DOUBLE_64 && var_symbol->type == INT32_TYPE && !HasZeroDecimalPlaces(literal->value.floating))
     {
         PrintError("Error in semantic analysis: Line %d: Incompatible types in expression", parser->line_number);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
@@ -904,83 +800,8 @@ int CheckLiteralVarCompatibilityBoolean(Token *literal, Token *var, Token *opera
     return 0;
 }
 
-void BooleanOperationLiteralId(Token *literal, VariableSymbol *id, Token *operator, bool literal_top_stack)
-{
-    // Check if the literal isn't an int and the variable is a double, if yes convert the int
-    if (literal->token_type == INTEGER_32 && id->type == DOUBLE64_TYPE)
-    {
-        // If the literal is on top of the stack, we can convert it directly
-        if (literal_top_stack)
-            INT2FLOATS
-
-        // The other case, we will need to use temporary variables, the variable is a double so we will temporarily store it in F0
-        else
-        {
-            // Store the variable in F0
-            PopToRegister(DOUBLE64_TYPE);
-
-            // Convert the literal to a float
-            INT2FLOATS
-
-            // Push the variable back
-            fprintf(stdout, "PUSHS GF@$F0\n");
-        }
-    }
-
-    // Do the same for float to int conversion
-    else if (literal->token_type == DOUBLE_64 && id->type == INT32_TYPE)
-    {
-        // If the literal is on top of the stack, we can convert it directly
-        if (literal_top_stack)
-            FLOAT2INTS
-
-        // The other case, we will need to use temporary variables, the variable is an int so we will temporarily store it in R0
-        else
-        {
-            // Store the variable in R0
-            PopToRegister(INT32_TYPE);
-
-            // Convert the literal to an int
-            FLOAT2INTS
-
-            // Push the variable back
-            fprintf(stdout, "PUSHS GF@$R0\n");
-        }
-    }
-
-    // Perform the given operation
-    switch (operator->token_type)
-    {
-    case EQUAL_OPERATOR:
-        EQS break;
-
-    case NOT_EQUAL_OPERATOR:
-        EQS
-            NOTS break;
-
-    case LESS_THAN_OPERATOR:
-        LTS break;
-
-    case LARGER_THAN_OPERATOR:
-        GTS break;
-
-    case LESSER_EQUAL_OPERATOR:
-        GTS
-            NOTS break;
-
-    case LARGER_EQUAL_OPERATOR:
-        LTS
-            NOTS break;
-
-    // Will literally never ever happen
-    default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in BooleanExpressionLiteralId");
-    }
-}
-
-bool ConvertConstVarsBoolean(VariableSymbol *lhs, VariableSymbol *rhs)
+bool ConvertConstVarsBoolean(VariableSymbol *lhs, VariableSymbol *rhs, OPERAND_CONVERSION *conversion)
 {
-    fprintf(stderr, "trying to convert vars %s and %s\n", lhs->name, rhs->name);
     if (!(lhs->is_const && lhs->value != NULL) && !(rhs->is_const && rhs->value != NULL))
         return false;
 
@@ -995,19 +816,15 @@ bool ConvertConstVarsBoolean(VariableSymbol *lhs, VariableSymbol *rhs)
         // Convert lhs to a float
         case INT32_TYPE:
         case INT32_NULLABLE_TYPE:
-            PopToRegister(DOUBLE64_TYPE);
-            INT2FLOATS
-            fprintf(stdout, "PUSHS GF@$F0\n");
+            *conversion = LEFT_INT2FLOAT;
             break;
 
         // Convert lhs to an int
         case DOUBLE64_TYPE:
         case DOUBLE64_NULLABLE_TYPE:
-            if (!HasZeroDecimalPlaces(lhs->value))
+            if (!HasZeroDecimalPlaces(lhs->const_value.floating))
                 return false;
-            PopToRegister(INT32_TYPE);
-            FLOAT2INTS
-            fprintf(stdout, "PUSHS GF@$R0\n");
+            *conversion = LEFT_FLOAT2INT;
             break;
 
         // Will never happen
@@ -1024,15 +841,15 @@ bool ConvertConstVarsBoolean(VariableSymbol *lhs, VariableSymbol *rhs)
         // Convert rhs to a float
         case INT32_TYPE:
         case INT32_NULLABLE_TYPE:
-            INT2FLOATS
+            *conversion = RIGHT_INT2FLOAT;
             break;
 
         // Convert rhs to an int
         case DOUBLE64_TYPE:
         case DOUBLE64_NULLABLE_TYPE:
-            if (!HasZeroDecimalPlaces(rhs->value))
+            if (!HasZeroDecimalPlaces(rhs->const_value.floating))
                 return false;
-            FLOAT2INTS
+            *conversion = RIGHT_FLOAT2INT;
             break;
 
         // Will never happen
@@ -1044,22 +861,22 @@ bool ConvertConstVarsBoolean(VariableSymbol *lhs, VariableSymbol *rhs)
     return true;
 }
 
-int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token *operator, Parser * parser)
+int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token *operator, Parser * parser, OPERAND_CONVERSION *conversion)
 {
     // Get the corresponding variable symbols
-    VariableSymbol *lhs = SymtableStackFindVariable(parser->symtable_stack, var_lhs->attribute);
-    VariableSymbol *rhs = SymtableStackFindVariable(parser->symtable_stack, var_rhs->attribute);
+    VariableSymbol *lhs = var_lhs->variable;
+    VariableSymbol *rhs = var_rhs->variable;
 
     // Check if the variables are defined
     if (lhs == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var_lhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var_lhs->length, var_lhs->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
     if (rhs == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, var_rhs->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, var_rhs->length, var_rhs->attribute);
         return ERROR_SEMANTIC_UNDEFINED;
     }
 
@@ -1067,7 +884,7 @@ int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token
     // Also, they have to match so not ?f64 == ?i32
     if (operator->token_type == EQUAL_OPERATOR || operator->token_type == NOT_EQUAL_OPERATOR)
     {
-        if (lhs->type != rhs->type && !ConvertConstVarsBoolean(lhs, rhs))
+        if (lhs->type != rhs->type && !ConvertConstVarsBoolean(lhs, rhs, conversion))
         {
             PrintError("Error in semantic analysis: Line %d: Incompatible types in expression", parser->line_number);
             return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
@@ -1084,7 +901,7 @@ int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token
     }
 
     // Their types have to match, or they both have to be constants with values known at compile time
-    if (lhs->type != rhs->type && !ConvertConstVarsBoolean(lhs, rhs))
+    if (lhs->type != rhs->type && !ConvertConstVarsBoolean(lhs, rhs, conversion))
     {
         PrintError("Error in semantic analysis: Line %d: Incompatible types in expression", parser->line_number);
         return ERROR_SEMANTIC_TYPE_COMPATIBILITY;
@@ -1093,308 +910,580 @@ int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token
     return 0;
 }
 
-void BooleanOperationTwoIds(Token *operator)
+// Arithmetic operators, their operations have a number as the result
+static bool IsArithmeticOperator(TOKEN_TYPE type)
 {
-    // Perform the operation based on the operator
-    switch (operator->token_type)
+    return type == MULTIPLICATION_OPERATOR || type == DIVISION_OPERATOR || type == ADDITION_OPERATOR || type == SUBSTRACTION_OPERATOR;
+}
+
+static bool IsRelationalOperator(TOKEN_TYPE type)
+{
+    return type == EQUAL_OPERATOR || type == NOT_EQUAL_OPERATOR || type == LESS_THAN_OPERATOR ||
+           type == LARGER_THAN_OPERATOR || type == LESSER_EQUAL_OPERATOR || type == LARGER_EQUAL_OPERATOR;
+}
+
+ExpressionTree *BuildExpressionTree(TokenVector *postfix)
+{
+    ExpressionTree *tree = ExpressionTreeInit(postfix->length);
+
+    for (int i = 0; i < postfix->length; i++)
     {
-    case EQUAL_OPERATOR:
-        EQS break;
+        Token *token = postfix->token_string[i];
 
-    case NOT_EQUAL_OPERATOR:
-        EQS
-            NOTS break;
+        // The terminator only ends the postfix, it isn't a part of the tree
+        if (token->token_type == SEMICOLON || token->token_type == R_ROUND_BRACKET)
+            continue;
 
-    case LESS_THAN_OPERATOR:
-        LTS break;
+        ExpressionTreeAppend(tree, token, IsArithmeticOperator(token->token_type) || IsRelationalOperator(token->token_type));
+    }
 
-    case LARGER_THAN_OPERATOR:
-        GTS break;
+    return tree;
+}
 
-    case LESSER_EQUAL_OPERATOR:
-        GTS
-            NOTS break;
+// Resolves the type of an operand node, the same checks the operands went through when they were pushed
+static int CheckOperand(ExpressionNode *node, Parser *parser)
+{
+    Token *token = node->token;
+    VariableSymbol *var = NULL;
 
-    case LARGER_EQUAL_OPERATOR:
-        LTS
-            NOTS break;
+    switch (token->token_type)
+    {
+    case INTEGER_32:
+        node->type = INT32_TYPE;
+        node->is_const = true;
+        return 0;
 
-    // Will literally never ever happen
+    case DOUBLE_64:
+        node->type = DOUBLE64_TYPE;
+        node->is_const = true;
+        return 0;
+
+    case KEYWORD:
+        if (token->keyword_type != NULL_TYPE)
+        {
+            PrintError("Error in semantic analysis: Line %d: Unexpected keyword \"%.*s\" in expression", parser->line_number, token->length, token->attribute);
+            return ERROR_SYNTACTIC;
+        }
+
+        node->type = NULL_DATA_TYPE;
+        node->nullable = node->is_const = true;
+        return 0;
+
+    case IDENTIFIER_TOKEN:
+        // Already looked up by ResolveIdentifiers()
+        if ((var = token->variable) == NULL)
+        {
+            PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, token->length, token->attribute);
+            return ERROR_SEMANTIC_UNDEFINED;
+        }
+
+        // Mark off the variable as used
+        var->was_used = true;
+
+        node->type = var->type;
+        node->nullable = IsNullable(var->type);
+        node->is_const = var->is_const && var->value != NULL;
+        return 0;
+
+    // Will never happen, but throw an error just in case
     default:
-        ErrorExit(ERROR_INTERNAL, "Invalid operator in BooleanExpressionTwoIds");
+        PrintError("Error in syntactic analysis: Line %d: Unexpected token in expression", parser->line_number);
+        return ERROR_SYNTACTIC;
     }
 }
 
-DATA_TYPE ParseExpression(TokenVector *postfix, Parser *parser)
+// Conversion which gives both operands the same type, unless both of them are variables (see ConvertConstVarsBoolean())
+static OPERAND_CONVERSION OperandConversion(ExpressionNode *left, ExpressionNode *right, bool left_id, bool right_id)
 {
-    // Variables used throughout the parsing
-    Token *token = NULL;                               // Input token
-    Token *operand_left = NULL, *operand_right = NULL; // Operand (stack top) tokens
-    DATA_TYPE result_type, return_type = INT32_TYPE;   // Intermediate and final data types
-    EvaluationStack *stack = EvaluationStackInit();    // Stack for evaluation
-    VariableSymbol *id_input = NULL;                   // Variable symbols for ID inputs
+    // A literal is converted to the type of the variable
+    if (left_id != right_id)
+    {
+        ExpressionNode *literal = left_id ? right : left;
+        ExpressionNode *id = left_id ? left : right;
 
-    // Replace the constants for easier generation
-    ReplaceConstants(postfix, parser);
+        if (literal->type == INT32_TYPE && id->type == DOUBLE64_TYPE)
+            return left_id ? RIGHT_INT2FLOAT : LEFT_INT2FLOAT;
+        else if (literal->type == DOUBLE64_TYPE && id->type == INT32_TYPE)
+            return left_id ? RIGHT_FLOAT2INT : LEFT_FLOAT2INT;
+    }
 
-    // Traverse the postfix string from left to right
-    for (int i = 0; i < postfix->length; i++)
+    // Of two literals, the int is converted to a float
+    else if (!left_id)
+    {
+        if (left->type == DOUBLE64_TYPE && right->type == INT32_TYPE)
+            return RIGHT_INT2FLOAT;
+        else if (left->type == INT32_TYPE && right->type == DOUBLE64_TYPE)
+            return LEFT_INT2FLOAT;
+    }
+
+    return NO_CONVERSION;
+}
+
+// Checks an operation whose operands were already checked and resolves its type and conversion
+static int CheckOperation(ExpressionTree *tree, ExpressionNode *node, Parser *parser)
+{
+    ExpressionNode *left = &tree->nodes[node->left];
+    ExpressionNode *right = &tree->nodes[node->right];
+
+    // The results of other operations count as literals
+    bool left_id = left->token->token_type == IDENTIFIER_TOKEN;
+    bool right_id = right->token->token_type == IDENTIFIER_TOKEN;
+    int error_code = 0;
+
+    if (IsArithmeticOperator(node->operator))
+    {
+        if (left_id && right_id)
+            error_code = CheckTwoVariablesCompatibilityArithmetic(left->token, right->token, parser);
+        else if (left_id || right_id)
+            error_code = CheckLiteralVarCompatibilityArithmetic(left_id ? right->token : left->token, left_id ? left->token : right->token, node->token, parser);
+        else
+            error_code = CheckLiteralsCompatibilityArithmetic(left->token, right->token, node->token, parser);
+
+        node->type = left->type == DOUBLE64_TYPE || right->type == DOUBLE64_TYPE ? DOUBLE64_TYPE : INT32_TYPE;
+    }
+
+    // Two literals are compared without a check
+    else
     {
-        token = postfix->token_string[i];
+        if (left_id && right_id)
+            error_code = CheckTwoVariablesCompatibilityBoolean(left->token, right->token, node->token, parser, &node->conversion);
+        else if (left_id || right_id)
+            error_code = CheckLiteralVarCompatibilityBoolean(left_id ? right->token : left->token, left_id ? left->token : right->token, node->token, parser);
+
+        node->type = BOOLEAN;
+    }
+
+    if (error_code != 0)
+        return error_code;
+
+    if (!left_id || !right_id)
+        node->conversion = OperandConversion(left, right, left_id, right_id);
+    node->is_const = left->is_const && right->is_const;
+
+    // The operator's token isn't needed anymore, so an arithmetic one becomes the artificial token of the result
+    if (node->type != BOOLEAN)
+        *node->token = (Token){.token_type = node->type == INT32_TYPE ? INTEGER_32 : DOUBLE_64, .keyword_type = NONE};
 
-        switch (token->token_type)
+    return 0;
+}
+
+int CheckExpressionTree(ExpressionTree *tree, Parser *parser)
+{
+    // Postfix order, so the operands are always resolved before their operation and the errors come in the order of the postfix
+    for (int i = 0; i < tree->length; i++)
+    {
+        ExpressionNode *node = &tree->nodes[i];
+        bool is_operation = node->left >= 0;
+
+        int error_code = is_operation ? CheckOperation(tree, node, parser) : CheckOperand(node, parser);
+        if (error_code != 0)
+            return error_code;
+
+        // The result of a relational operation can't be used by another operation
+        if (is_operation && node->type == BOOLEAN && i != tree->length - 1)
         {
-        // If the token is an operand, push it onto the stack
-        case INTEGER_32:
-        case DOUBLE_64:
-        case IDENTIFIER_TOKEN:
-        case KEYWORD:
-            // Switch up the resulting type
-            if (token->token_type == DOUBLE_64)
-                return_type = DOUBLE64_TYPE;
-
-            if (token->token_type == KEYWORD && token->keyword_type != NULL_TYPE)
-            {
-                PrintError("Error in semantic analysis: Line %d: Unexpected keyword \"%s\" in expression", parser->line_number, token->attribute);
-                DestroyEvaluationStackAndVector(postfix, stack);
-                CLEANUP
-                exit(ERROR_SYNTACTIC);
-            }
+            PrintError("Error in semantic analysis: Line %d: Unexpected token after boolean expression", parser->line_number);
+            return ERROR_SYNTACTIC;
+        }
+    }
 
-            // Check if the identifier isn't either undefined, or nullable
-            if (token->token_type == IDENTIFIER_TOKEN)
-            {
-                // Look throughout the stack
-                id_input = SymtableStackFindVariable(parser->symtable_stack, token->attribute);
+    return 0;
+}
 
-                // Variable is undefined
-                if (id_input == NULL)
-                {
-                    PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", parser->line_number, token->attribute);
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(ERROR_SEMANTIC_UNDEFINED);
-                }
+// Runtime value of an operand node which is known at compile time, kind is INTEGER_32 or DOUBLE_64
+static bool NodeConstant(ExpressionNode *node, TOKEN_TYPE *kind, NumberValue *value)
+{
+    // Operations which weren't folded
+    if (node->left >= 0)
+        return false;
 
-                // Mark off the variable as used
-                id_input->was_used = true;
+    Token *token = node->token;
+    if (token->token_type == INTEGER_32 || token->token_type == DOUBLE_64)
+    {
+        *kind = token->token_type;
+        *value = token->value;
+    }
 
-                // Change the return type if the variable is a double
-                if (id_input->type == DOUBLE64_TYPE)
-                    return_type = DOUBLE64_TYPE;
-            }
+    // Constants initialized with a literal, which is what their DEFVAR was moved, or with an expression which was folded
+    else if (token->token_type == IDENTIFIER_TOKEN && (node->is_const || token->variable->folded) &&
+             (node->type == INT32_TYPE || node->type == DOUBLE64_TYPE))
+    {
+        *kind = node->type == INT32_TYPE ? INTEGER_32 : DOUBLE_64;
+        *value = token->variable->const_value;
+    }
 
-            // Push the operand and process the next token
-            EvaluationStackPush(stack, token);
-            PUSHS(token->attribute, token->token_type, LOCAL_FRAME);
-            break;
+    else
+        return false;
+
+    // Only i32 values, anything out of range is left to the interpreter
+    return *kind == DOUBLE_64 || (value->integer >= INT32_MIN && value->integer <= INT32_MAX);
+}
+
+// Does INT2FLOATS (to_float) or FLOAT2INTS on a constant, false if it would fail or truncate something at run time
+static bool FoldConversion(TOKEN_TYPE *kind, NumberValue *value, bool to_float)
+{
+    if (to_float)
+    {
+        if (*kind != INTEGER_32)
+            return false;
+
+        value->floating = (double)value->integer;
+        *kind = DOUBLE_64;
+        return true;
+    }
 
-        // Arithmetic operators
+    if (*kind != DOUBLE_64 || value->floating < INT32_MIN || value->floating > INT32_MAX ||
+        (double)(int64_t)value->floating != value->floating)
+        return false;
+
+    value->integer = (int64_t)value->floating;
+    *kind = INTEGER_32;
+    return true;
+}
+
+// Computes an arithmetic operation on two constants of the same kind, false if it's left to run time
+static bool FoldArithmetic(TOKEN_TYPE operator, DATA_TYPE type, TOKEN_TYPE kind, NumberValue left, NumberValue right, NumberValue *result)
+{
+    if (kind == INTEGER_32)
+    {
+        // Both operands are i32s, so nothing here overflows an int64_t
+        int64_t value;
+        switch (operator)
+        {
         case MULTIPLICATION_OPERATOR:
-        case DIVISION_OPERATOR:
+            value = left.integer * right.integer;
+            break;
+
         case ADDITION_OPERATOR:
+            value = left.integer + right.integer;
+            break;
+
         case SUBSTRACTION_OPERATOR:
-            // All of these are binary, so pop two operands from the stack
-            operand_right = EvaluationStackPop(stack);
-            operand_left = EvaluationStackPop(stack);
-
-            /* Four possible options:
-                1. Neither operand is an ID
-                2. Operand 1 is an ID
-                3. Operand 2 is an ID
-                4. Both operands are IDs
-            */
-
-            // Case 1
-            if (operand_left->token_type != IDENTIFIER_TOKEN && operand_right->token_type != IDENTIFIER_TOKEN)
-            {
-                // Check the validity of the operation
-                int error_code = CheckLiteralsCompatibilityArithmetic(operand_left, operand_right, token, parser);
+            value = left.integer - right.integer;
+            break;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+        // IDIVS truncates towards zero like C, DIVS of two ints and the division by zero fail at run time
+        case DIVISION_OPERATOR:
+            if (type == DOUBLE64_TYPE || right.integer == 0)
+                return false;
+            value = left.integer / right.integer;
+            break;
 
-                result_type = ArithmeticOperationTwoLiterals(operand_left, operand_right, token);
-            }
+        default:
+            return false;
+        }
 
-            // Case 2a (the left operand is an ID)
-            else if (operand_left->token_type == IDENTIFIER_TOKEN && operand_right->token_type != IDENTIFIER_TOKEN)
-            {
-                // Check the validity of the operation
-                int error_code = CheckLiteralVarCompatibilityArithmetic(operand_right, operand_left, token, parser);
+        // An overflowing result is left to the interpreter as well
+        if (value < INT32_MIN || value > INT32_MAX)
+            return false;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+        result->integer = value;
+        return true;
+    }
 
-                VariableSymbol *id = SymtableStackFindVariable(parser->symtable_stack, operand_left->attribute);
+    double value;
+    switch (operator)
+    {
+    case MULTIPLICATION_OPERATOR:
+        value = left.floating * right.floating;
+        break;
 
-                result_type = ArithmeticOperationLiteralId(operand_right, id, token, true);
-            }
+    case ADDITION_OPERATOR:
+        value = left.floating + right.floating;
+        break;
 
-            // Case 2b (the right operand is an ID)
-            else if (operand_left->token_type != IDENTIFIER_TOKEN && operand_right->token_type == IDENTIFIER_TOKEN)
-            {
-                // Check the validity of the operation
-                int error_code = CheckLiteralVarCompatibilityArithmetic(operand_left, operand_right, token, parser);
+    case SUBSTRACTION_OPERATOR:
+        value = left.floating - right.floating;
+        break;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+    // The same with IDIVS of two floats
+    case DIVISION_OPERATOR:
+        if (type != DOUBLE64_TYPE || right.floating == 0.0)
+            return false;
+        value = left.floating / right.floating;
+        break;
 
-                VariableSymbol *id = SymtableStackFindVariable(parser->symtable_stack, operand_right->attribute);
+    default:
+        return false;
+    }
 
-                result_type = ArithmeticOperationLiteralId(operand_left, id, token, false);
-            }
+    // inf and nan have no literal
+    if (!isfinite(value))
+        return false;
 
-            // Case 3
-            else
-            {
-                // Check the validity of the operation
-                int error_code = CheckTwoVariablesCompatibilityArithmetic(operand_left, operand_right, parser);
+    result->floating = value;
+    return true;
+}
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+// Computes a relational operation on two constants of the same kind
+static bool FoldRelational(TOKEN_TYPE operator, TOKEN_TYPE kind, NumberValue left, NumberValue right)
+{
+    // i32 values are exact as doubles
+    double lhs = kind == INTEGER_32 ? (double)left.integer : left.floating;
+    double rhs = kind == INTEGER_32 ? (double)right.integer : right.floating;
 
-                VariableSymbol *lhs = SymtableStackFindVariable(parser->symtable_stack, operand_left->attribute);
-                VariableSymbol *rhs = SymtableStackFindVariable(parser->symtable_stack, operand_right->attribute);
+    switch (operator)
+    {
+    case EQUAL_OPERATOR:
+        return lhs == rhs;
 
-                // Get the resulting type
-                result_type = ArithmeticOperationTwoIds(lhs, rhs, token);
-            }
+    case NOT_EQUAL_OPERATOR:
+        return lhs != rhs;
 
-            /* Now we can push the result back onto the stack
-                - We have to create an artificial token for the result
-            */
-            Token *result = InitToken();
-            result->token_type = result_type == INT32_TYPE ? INTEGER_32 : DOUBLE_64;
-            EvaluationStackPush(stack, result);
+    case LESS_THAN_OPERATOR:
+        return lhs < rhs;
 
-            return_type = result_type;
+    case LARGER_THAN_OPERATOR:
+        return lhs > rhs;
 
-            break;
+    case LESSER_EQUAL_OPERATOR:
+        return lhs <= rhs;
 
-        // Boolean operators
-        case EQUAL_OPERATOR:
-        case NOT_EQUAL_OPERATOR:
-        case LESS_THAN_OPERATOR:
-        case LARGER_THAN_OPERATOR:
-        case LESSER_EQUAL_OPERATOR:
-        case LARGER_EQUAL_OPERATOR:
-            // Again, all of these are binary, so pop two operands from the stack
-            operand_right = EvaluationStackPop(stack);
-            operand_left = EvaluationStackPop(stack);
-
-            /* Once again, we have 3 cases
-                1. Neither operand is an ID
-                2. 1 operand is an ID
-                3. Both operands are IDs
-            */
-
-            // Case 1
-            if (operand_left->token_type != IDENTIFIER_TOKEN && operand_right->token_type != IDENTIFIER_TOKEN)
-                BooleanOperationTwoLiterals(operand_left, operand_right, token);
-
-            // Case 2a (the left operand is an ID)
-            else if (operand_left->token_type == IDENTIFIER_TOKEN && operand_right->token_type != IDENTIFIER_TOKEN)
-            {
-                // Check the validity of the operation
-                int error_code = CheckLiteralVarCompatibilityBoolean(operand_right, operand_left, token, parser);
+    case LARGER_EQUAL_OPERATOR:
+        return lhs >= rhs;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+    // Will never happen
+    default:
+        return false;
+    }
+}
 
-                VariableSymbol *id = SymtableStackFindVariable(parser->symtable_stack, operand_left->attribute);
+// (a * c1) * c2 becomes a * (c1 * c2), the same for +, if everything is an i32 without conversions
+static void ReassociateOperation(ExpressionTree *tree, ExpressionNode *node, NumberValue right_value)
+{
+    ExpressionNode *inner = &tree->nodes[node->left];
+    if (inner->left < 0 || inner->operator != node->operator ||
+        (node->operator != MULTIPLICATION_OPERATOR && node->operator != ADDITION_OPERATOR))
+        return;
 
-                BooleanOperationLiteralId(operand_right, id, token, true);
-            }
+    if (node->type != INT32_TYPE || inner->type != INT32_TYPE || node->conversion != NO_CONVERSION || inner->conversion != NO_CONVERSION)
+        return;
 
-            // Case 2b (the right operand is an ID)
-            else if (operand_left->token_type != IDENTIFIER_TOKEN && operand_right->token_type == IDENTIFIER_TOKEN)
-            {
-                // Check the validity of the operation
-                int error_code = CheckLiteralVarCompatibilityBoolean(operand_left, operand_right, token, parser);
+    ExpressionNode *constant = &tree->nodes[inner->right];
+    TOKEN_TYPE kind;
+    NumberValue value, result;
+    if (!NodeConstant(constant, &kind, &value) || kind != INTEGER_32)
+        return;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+    // A multiplication by zero could hide an overflow of the inner one
+    if (node->operator == MULTIPLICATION_OPERATOR && (value.integer == 0 || right_value.integer == 0))
+        return;
 
-                VariableSymbol *id = SymtableStackFindVariable(parser->symtable_stack, operand_right->attribute);
+    if (!FoldArithmetic(node->operator, INT32_TYPE, INTEGER_32, value, right_value, &result))
+        return;
 
-                BooleanOperationLiteralId(operand_left, id, token, false);
-            }
+    // The operation takes over the operands of the inner one, whose constant is now the folded one
+    *constant->token = (Token){.token_type = INTEGER_32, .keyword_type = NONE, .value = result};
+    tree->nodes[node->right].absorbed = inner->absorbed = true;
+    node->left = inner->left;
+    node->right = inner->right;
+}
 
-            // Case 3
-            else
-            {
-                // Check the validity of the operation
-                int error_code = CheckTwoVariablesCompatibilityBoolean(operand_left, operand_right, token, parser);
+void FoldExpressionTree(ExpressionTree *tree)
+{
+    // Postfix order, so the operands are folded before their operation
+    for (int i = 0; i < tree->length; i++)
+    {
+        ExpressionNode *node = &tree->nodes[i];
+        if (node->left < 0)
+            continue;
 
-                // The error message was already printed
-                if (error_code != 0)
-                {
-                    DestroyEvaluationStackAndVector(postfix, stack);
-                    CLEANUP
-                    exit(error_code);
-                }
+        ExpressionNode *left = &tree->nodes[node->left];
+        ExpressionNode *right = &tree->nodes[node->right];
+        TOKEN_TYPE left_kind, right_kind;
+        NumberValue left_value, right_value, result;
 
-                BooleanOperationTwoIds(token);
-            }
+        if (!NodeConstant(right, &right_kind, &right_value))
+            continue;
 
-            return_type = BOOLEAN;
+        if (!NodeConstant(left, &left_kind, &left_value))
+        {
+            if (right_kind == INTEGER_32)
+                ReassociateOperation(tree, node, right_value);
+            continue;
+        }
 
-            // Check if the next token is a expression separator
-            if (postfix->token_string[i + 1]->token_type != SEMICOLON && postfix->token_string[i + 1]->token_type != R_ROUND_BRACKET)
-            {
-                PrintError("Error in semantic analysis: Line %d: Unexpected token after boolean expression", parser->line_number);
-                DestroyEvaluationStackAndVector(postfix, stack);
-                CLEANUP
-                exit(ERROR_SYNTACTIC);
-            }
+        // The conversion the operation would do on the data stack
+        bool converted = true;
+        switch (node->conversion)
+        {
+        case LEFT_INT2FLOAT:
+        case LEFT_FLOAT2INT:
+            converted = FoldConversion(&left_kind, &left_value, node->conversion == LEFT_INT2FLOAT);
+            break;
 
+        case RIGHT_INT2FLOAT:
+        case RIGHT_FLOAT2INT:
+            converted = FoldConversion(&right_kind, &right_value, node->conversion == RIGHT_INT2FLOAT);
             break;
 
-        // End of expression, result is on top of the stack
-        case SEMICOLON:
-        case R_ROUND_BRACKET:
+        case NO_CONVERSION:
             break;
+        }
+
+        // The instructions fail on operands of different types, so the operation stays for the interpreter to report it
+        if (!converted || left_kind != right_kind)
+            continue;
+
+        if (IsArithmeticOperator(node->operator))
+        {
+            if (!FoldArithmetic(node->operator, node->type, left_kind, left_value, right_value, &result))
+                continue;
+
+            // The kind can differ from the node's type (f64 operands converted to ints), it's what the instructions would push
+            *node->token = (Token){.token_type = left_kind, .keyword_type = NONE, .value = result};
+        }
 
-        // Will never happen, but throw an error just in case
+        else if (FoldRelational(node->operator, left_kind, left_value, right_value))
+            *node->token = (Token){.token_type = BOOLEAN_TOKEN, .keyword_type = NONE, .attribute = "true", .length = 4};
+        else
+            *node->token = (Token){.token_type = BOOLEAN_TOKEN, .keyword_type = NONE, .attribute = "false", .length = 5};
+
+        // The node is pushed as a literal now
+        left->absorbed = right->absorbed = true;
+        node->left = node->right = -1;
+        node->conversion = NO_CONVERSION;
+    }
+}
+
+void GenerateExpressionTree(ExpressionTree *tree)
+{
+    for (int i = 0; i < tree->length; i++)
+    {
+        ExpressionNode *node = &tree->nodes[i];
+        if (node->absorbed)
+            continue;
+
+        // The operands are pushed as they come, so an operation always has its two operands on top of the stack
+        if (node->left < 0)
+        {
+            PUSHS(node->token, LOCAL_FRAME);
+            continue;
+        }
+
+        switch (node->conversion)
+        {
+        // The right operand is a double, it waits in F0 while the left one is converted
+        case LEFT_INT2FLOAT:
+            PopToRegister(DOUBLE64_TYPE);
+            INT2FLOATS
+            fprintf(stdout, "PUSHS GF@$F0\n");
+            break;
+
+        // The right operand is an int, it waits in R0
+        case LEFT_FLOAT2INT:
+            PopToRegister(INT32_TYPE);
+            FLOAT2INTS
+            fprintf(stdout, "PUSHS GF@$R0\n");
+            break;
+
+        case RIGHT_INT2FLOAT:
+            INT2FLOATS break;
+
+        case RIGHT_FLOAT2INT:
+            FLOAT2INTS break;
+
+        case NO_CONVERSION:
+            break;
+        }
+
+        switch (node->operator)
+        {
+        case MULTIPLICATION_OPERATOR:
+            MULS break;
+
+        case DIVISION_OPERATOR:
+            if (node->type == DOUBLE64_TYPE)
+                DIVS else IDIVS break;
+
+        case ADDITION_OPERATOR:
+            ADDS break;
+
+        case SUBSTRACTION_OPERATOR:
+            SUBS break;
+
+        case EQUAL_OPERATOR:
+            EQS break;
+
+        case NOT_EQUAL_OPERATOR:
+            EQS
+                NOTS break;
+
+        case LESS_THAN_OPERATOR:
+            LTS break;
+
+        case LARGER_THAN_OPERATOR:
+            GTS break;
+
+        case LESSER_EQUAL_OPERATOR:
+            GTS
+                NOTS break;
+
+        case LARGER_EQUAL_OPERATOR:
+            LTS
+                NOTS break;
+
+        // Will literally never ever happen
         default:
-            PrintError("Error in syntactic analysis: Line %d: Unexpected token in expression", parser->line_number);
-            DestroyEvaluationStackAndVector(postfix, stack);
-            CLEANUP
-            exit(ERROR_SYNTACTIC);
+            ErrorExit(ERROR_INTERNAL, "Invalid operator in GenerateExpressionTree");
         }
     }
+}
+
+#ifndef IFJ24_NO_FOLDING
+// Remembers the value of a constant whose initializer was folded into a single operand of the constant's type
+static void RecordFoldedConstant(ExpressionTree *tree, VariableSymbol *constant, DATA_TYPE type)
+{
+    TOKEN_TYPE kind;
+    NumberValue value;
+    if (tree->length == 0 || !NodeConstant(&tree->nodes[tree->length - 1], &kind, &value))
+        return;
+
+    // What's stored in the variable at run time is what was pushed, so the kinds have to match
+    if ((kind == INTEGER_32 && type == INT32_TYPE) || (kind == DOUBLE_64 && type == DOUBLE64_TYPE))
+    {
+        constant->const_value = value;
+        constant->folded = true;
+    }
+}
+#endif
+
+DATA_TYPE ParseExpression(TokenVector *postfix, Parser *parser, VariableSymbol *constant)
+{
+    // Bind the identifiers to their symbols and replace the constants for easier generation
+    ResolveIdentifiers(postfix, parser);
+    ReplaceConstants(postfix);
+
+    // Type the whole expression first, nothing is generated for an expression with an error
+    ExpressionTree *tree = BuildExpressionTree(postfix);
+    int error_code = CheckExpressionTree(tree, parser);
+
+    // The error message was already printed
+    if (error_code != 0)
+    {
+        DestroyExpressionTreeAndVector(postfix, tree);
+        CLEANUP
+        exit(error_code);
+    }
+
+    // A single operand is an i32 unless it's an f64 (the callers check nullable variables themselves)
+    DATA_TYPE return_type = INT32_TYPE;
+    if (tree->length != 0)
+    {
+        ExpressionNode *root = &tree->nodes[tree->length - 1];
+        if (root->left >= 0 || root->type == DOUBLE64_TYPE)
+            return_type = root->type;
+    }
+
+#ifndef IFJ24_NO_FOLDING
+    FoldExpressionTree(tree);
+    if (constant != NULL)
+        RecordFoldedConstant(tree, constant, constant->type == VOID_TYPE ? return_type : constant->type);
+#else
+    (void)constant;
+#endif
+    GenerateExpressionTree(tree);
 
-    DestroyEvaluationStackAndVector(postfix, stack);
+    DestroyExpressionTreeAndVector(postfix, tree);
     return return_type;
 }
@@ -53,33 +53,55 @@ EXPRESSION_RULE FindRule(ExpressionStack *stack, int distance);
  */
 void ReduceToNonterminal(ExpressionStack *stack, TokenVector *postfix, EXPRESSION_RULE rule);
 
+// The engine expressions are converted with, the precedence table unless the build sets -DIFJ24_PRECEDENCE
+#ifdef IFJ24_PRECEDENCE
+#define DEFAULT_EXPRESSION_ENGINE PRECEDENCE_ENGINE
+#else
+#define DEFAULT_EXPRESSION_ENGINE TABLE_ENGINE
+#endif
+
+// Selects the engine InfixToPostfix() uses (the -e option)
+void SetExpressionEngine(EXPRESSION_ENGINE engine);
+
 /**
  * @brief Converts the next expression starting at getchar() to postfix notation
  *
  * @param parser mostly to keep track in case of an error
  *
- * @return TokenVector* Vector containing a postfix string
+ * @return TokenVector* Vector containing a postfix string, it borrows the tokens read from the stream (nothing is copied)
  *
- * @note This algorhitm was heavily inspired by the IAL course implementation
+ * @note This algorhitm was heavily inspired by the IAL course implementation. With PRECEDENCE_ENGINE selected,
+ * the expression is converted by PrecedenceToPostfix() instead
  */
 TokenVector *InfixToPostfix(Parser *parser);
 
 /**
- * @brief Ran in preparation for expression codegen. Replaces all variables with values known at compile time with their values.
+ * @brief Converts the next expression to postfix notation with the shunting-yard algorithm
+ *
+ * Every token is looked at once: operands go straight to the postfix, an operator first moves the operators
+ * which bind at least as tight (by their binding powers, so all of them are left associative) from its stack to the postfix.
+ * It doesn't recurse, so any nesting of brackets is fine.
+ *
+ * @param parser mostly to keep track in case of an error
+ * @return TokenVector* The same postfix InfixToPostfix() gives with the precedence table
+ */
+TokenVector *PrecedenceToPostfix(Parser *parser);
+
+/**
+ * @brief Ran first in preparation for expression codegen. Binds every identifier of the expression to its variable symbol
+ * (token->variable, NULL if it's undefined), the rest of the expression parsing only reads these bindings.
  *
  * @param postfix Postfix representation of the expression.
  */
-void ReplaceConstants(TokenVector *postfix, Parser *parser);
+void ResolveIdentifiers(TokenVector *postfix, Parser *parser);
 
 /**
- * @brief Used when freeing operand tokens in the EvaluatePostfixExpression function. Checks if the token can be freed
+ * @brief Ran in preparation for expression codegen. Replaces all variables with values known at compile time with their values.
+ * The identifier tokens are turned into the literals in place, so nothing is allocated.
  *
- * @param postfix The postfix string of tokens
- * @param token The token to search for
- * @return true If the token is included in the postfix vector
- * @return false If the token is not included in the postfix vector
+ * @param postfix Postfix representation of the expression.
  */
-bool IsTokenInString(TokenVector *postfix, Token *token);
+void ReplaceConstants(TokenVector *postfix);
 
 /**
  * @brief Checks if a variable symbol is of a nullable type
@@ -90,22 +112,22 @@ bool IsTokenInString(TokenVector *postfix, Token *token);
 bool IsNullable(DATA_TYPE type);
 
 /**
- * @brief Help function to avoid double frees, utilizes IsTokenInString
+ * @brief Frees the postfix vector and the stack used to build it (the tokens are owned by the token arena)
  *
- * @param postfix The token vector to search in and destroy
- * @param stack The stack to search in and destroy
+ * @param postfix The token vector to destroy
+ * @param stack The stack to destroy
  */
 void DestroyExpressionStackAndVector(TokenVector *postfix, ExpressionStack *stack);
 
-// The same as the previous function, but for the EvaluationStack
-void DestroyEvaluationStackAndVector(TokenVector *postfix, EvaluationStack *stack);
+// The same as the previous function, but for the expression tree
+void DestroyExpressionTreeAndVector(TokenVector *postfix, ExpressionTree *tree);
 
 /**
  * @brief Checks if a float value has zero decimal places
  *
- * @param float_value String representation of the float value
+ * @param val The float value (token->value.floating or symbol->const_value.floating)
  */
-bool HasZeroDecimalPlaces(char *float_value);
+bool HasZeroDecimalPlaces(double val);
 
 /**
  * @brief Checks if two literals used in a expression together are compatible. (Aren't only with different types and the '/' operator)
@@ -119,15 +141,6 @@ bool HasZeroDecimalPlaces(char *float_value);
  */
 int CheckLiteralsCompatibilityArithmetic(Token *literal_left, Token *literal_right, Token *operator, Parser * parser);
 
-/**
- * @brief Generates code for a arithmetic operation between two literals
- *
- * @param operand_left Left operand literal
- * @param operand_right Right operand literal
- * @param operator Resulting type of the expression
- */
-DATA_TYPE ArithmeticOperationTwoLiterals(Token *operand_left, Token *operand_right, Token *operator);
-
 /**
  * @brief Checks compatibility between operands, where one is a variable and the other is a literal
  *
@@ -140,17 +153,6 @@ DATA_TYPE ArithmeticOperationTwoLiterals(Token *operand_left, Token *operand_rig
  */
 int CheckLiteralVarCompatibilityArithmetic(Token *literal, Token *var, Token *operator, Parser * parser);
 
-/**
- * @brief Generates code for an operation between a literal and an identifier
- *
- * @param literal The literal operand
- * @param id The identifier operand
- * @param operator The operator token
- * @param literal_top_stack If the literal is on top of the stack, to know how to generate code
- * @return DATA_TYPE The type of the expression
- */
-DATA_TYPE ArithmeticOperationLiteralId(Token *literal, VariableSymbol *id, Token *operator, bool literal_top_stack);
-
 /**
  * @brief Checks compatibility between two variables
  *
@@ -162,16 +164,6 @@ DATA_TYPE ArithmeticOperationLiteralId(Token *literal, VariableSymbol *id, Token
  */
 int CheckTwoVariablesCompatibilityArithmetic(Token *var_lhs, Token *var_rhs, Parser *parser);
 
-/**
- * @brief Generates code for an operation between two identifiers
- *
- * @param operand_left Lhs operand
- * @param operand_right Rhs operand
- * @param operator Operation to perform
- * @return DATA_TYPE Resulting type of the expression
- */
-DATA_TYPE ArithmeticOperationTwoIds(VariableSymbol *operand_left, VariableSymbol *operand_right, Token *operator);
-
 /**
  * @brief Checks the validity of a boolean expression between two literals
  *
@@ -184,17 +176,6 @@ DATA_TYPE ArithmeticOperationTwoIds(VariableSymbol *operand_left, VariableSymbol
  */
 int CheckCompatibilityLiteralsBoolean(Token *literal_left, Token *literal_right, Token *operator, Parser * parser);
 
-/**
- * @brief Generates code for an operation between two literals
- *
- * @param operand_left Lhs operand
- * @param operand_right Rhs operand
- * @param operator Operation to perform
- *
- * @return DATA_TYPE Resulting type of the expression
- */
-void BooleanOperationTwoLiterals(Token *operand_left, Token *operand_right, Token *operator);
-
 /**
  * @brief Checks compatibility between operands, where one is a variable and the other is a literal
  *
@@ -208,24 +189,15 @@ void BooleanOperationTwoLiterals(Token *operand_left, Token *operand_right, Toke
 int CheckLiteralVarCompatibilityBoolean(Token *literal, Token *var, Token *operator, Parser * parser);
 
 /**
- * @brief Generates code for an operation between a literal and an identifier
- *
- * @param literal The literal operand
- * @param id The identifier operand
- * @param operator The operator token
- * @param literal_top_stack If the literal is on top of the stack, to know how to generate code
- */
-void BooleanOperationLiteralId(Token *literal, VariableSymbol *id, Token *operator, bool literal_top_stack);
-
-/**
- * @brief Help function for CheckTwoVariablesCompatibilityBoolean, converts const vars with different types to the same type if posssible
+ * @brief Help function for CheckTwoVariablesCompatibilityBoolean, finds how const vars with different types are converted to the same type if posssible
  *
  * @param var_lhs Lhs variable
  * @param var_rhs Rhs variable
+ * @param conversion Set to the conversion of the constant, which is generated right before the operation
  *
  * @return false in case of an error, true if the variables are compatible
  */
-bool ConvertConstVarsBoolean(VariableSymbol *var_lhs, VariableSymbol *var_rhs);
+bool ConvertConstVarsBoolean(VariableSymbol *var_lhs, VariableSymbol *var_rhs, OPERAND_CONVERSION *conversion);
 
 /**
  * @brief Checks compatibility between two variables
@@ -235,24 +207,56 @@ bool ConvertConstVarsBoolean(VariableSymbol *var_lhs, VariableSymbol *var_rhs);
  * @param parser Pointer to the parser structure
  * @return int Error code in case of an error, 0 if the variables are compatible
  */
-int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token *operator, Parser * parser);
+int CheckTwoVariablesCompatibilityBoolean(Token *var_lhs, Token *var_rhs, Token *operator, Parser * parser, OPERAND_CONVERSION *conversion);
 
 /**
- * @brief Generates code for an operation between two identifiers
+ * @brief Builds the typed tree of a postfix expression, its nodes keep the order of the postfix
  *
- * @param operator Operation to perform
+ * @param postfix The postfix string of tokens, the tree borrows its tokens
+ * @return ExpressionTree* The tree, its types are resolved by CheckExpressionTree()
+ */
+ExpressionTree *BuildExpressionTree(TokenVector *postfix);
+
+/**
+ * @brief Resolves the type, nullability and constness of every node and checks the operations, nothing is generated
+ *
+ * @param tree The tree built by BuildExpressionTree()
+ * @param parser Pointer to the parser structure
+ *
+ * @return int Exit code. If 0, the expression is valid, else exit with the returned value (the message is already printed)
+ */
+int CheckExpressionTree(ExpressionTree *tree, Parser *parser);
+
+/**
+ * @brief Folds the operations whose operands are known at compile time (literals and constants with a literal or folded value)
+ *
+ * The folded operation becomes an operand with the computed value, nothing is generated for its operands.
+ * Only what the instructions would compute the same way is folded: i32 results, divisions by nonzero values
+ * and operands whose types match after the conversions, everything else is left to run time.
+ * Chains like x * 60 * 60 are folded into x * 3600 (only i32 * and +).
+ *
+ * @param tree The tree checked by CheckExpressionTree()
+ */
+void FoldExpressionTree(ExpressionTree *tree);
+
+/**
+ * @brief Generates the stack code of a checked tree, the operands are pushed and the operations done in postfix order
+ *
+ * @param tree The tree checked by CheckExpressionTree()
  */
-void BooleanOperationTwoIds(Token *operator);
+void GenerateExpressionTree(ExpressionTree *tree);
 
 /**
  * @brief Parses the expression and returns the type of the expression
  *
  * @param postfix The postfix string of tokens
  * @param parser The parser structure
+ * @param constant The constant initialized by the expression (or NULL), if the expression folds to a number of its type,
+ *                 the constant keeps it for folding the expressions it's used in
  *
  * @return DATA_TYPE The type of the expression
  */
-DATA_TYPE ParseExpression(TokenVector *postfix, Parser *parser);
+DATA_TYPE ParseExpression(TokenVector *postfix, Parser *parser, VariableSymbol *constant);
 
 /*----------DEBUG FUNCTIONS----------*/
 void PrintPostfix(TokenVector *postfix);
@@ -24,6 +24,8 @@
 #include "vector.h"
 #include "stack.h"
 #include "scanner.h"
+#include "interner.h"
+#include "parallel_scan.h"
 // pub fn id ( seznam_parametrů ) návratový_typ {
 // sekvence_příkazů
 // }
@@ -38,15 +40,15 @@ void ParseIfWhile(Parser *parser)
     // loops through expression until )
     while (counter)
     {
-        token = LoadTokenFromStream(&parser->line_number);
+        token = ScanToken(&parser->line_number);
         if (token->token_type == L_ROUND_BRACKET)
         {
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
             counter++;
         }
         else if (token->token_type == R_ROUND_BRACKET)
         {
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
             counter--;
         }
         else if (token->token_type == EOF_TOKEN)
@@ -55,17 +57,17 @@ void ParseIfWhile(Parser *parser)
         }
         else
         {
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
         }
     }
 
     // checks if the next token is a vertical bar
-    token = LoadTokenFromStream(&parser->line_number);
+    token = ScanToken(&parser->line_number);
     if (token->token_type == VERTICAL_BAR_TOKEN)
     {
-        AppendToken(stream, token);
+        StreamAppendToken(stream, token);
         token = CheckAndReturnTokenStream(parser, IDENTIFIER_TOKEN);
-        AppendStringArray(&parser->current_function->variables, token->attribute);
+        AppendStringArray(&parser->current_function->variables, token->symbol_id);
         CheckTokenTypeStream(parser, VERTICAL_BAR_TOKEN);
         CheckTokenTypeStream(parser, L_CURLY_BRACKET);
         return;
@@ -76,7 +78,7 @@ void ParseIfWhile(Parser *parser)
         ErrorExit(ERROR_SYNTACTIC, "Line %d: Expected '{' after variable declaration", parser->line_number);
     }
 
-    AppendToken(stream, token);
+    StreamAppendToken(stream, token);
     return;
 }
 
@@ -91,7 +93,7 @@ void ParseVariableDeclaration(Parser *parser)
         PrintError("Error in semantic analysis: Line %d: Expected identifier", parser->line_number);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SYNTACTIC);
     }
 
@@ -100,17 +102,17 @@ void ParseVariableDeclaration(Parser *parser)
         PrintError("Error in semantic analysis: Line %d: Variable declaration outside of a function", parser->line_number);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_OTHER); // TODO
     }
 
-    if (strcmp(token->attribute, "ifj") == 0)
+    if (SYMBOL_IDS_EQUAL(token->symbol_id, ifj_symbol_id))
     {
         return;
     }
 
     // Add the variable name to the current function's variables array
-    AppendStringArray(&parser->current_function->variables, token->attribute);
+    AppendStringArray(&parser->current_function->variables, token->symbol_id);
 }
 
 void ParseConstDeclaration(Parser *parser)
@@ -123,12 +125,12 @@ void ParseConstDeclaration(Parser *parser)
         ErrorExit(ERROR_SYNTACTIC, "Expected identifier at line %d", parser->line_number);
     }
 
-    if (strcmp(token->attribute, "ifj") == 0 || parser->current_function == NULL)
+    if (SYMBOL_IDS_EQUAL(token->symbol_id, ifj_symbol_id) || parser->current_function == NULL)
     {
         return;
     }
 
-    AppendStringArray(&parser->current_function->variables, token->attribute);
+    AppendStringArray(&parser->current_function->variables, token->symbol_id);
 }
 
 void ParseFunctionDefinition(Parser *parser)
@@ -143,10 +145,11 @@ void ParseFunctionDefinition(Parser *parser)
     FunctionSymbol *func;
 
     // Check if the function exists already (so if it was redefined, which is an error)
-    if ((func = FindFunctionSymbol(parser->global_symtable, token->attribute)) == NULL)
+    if ((func = FindFunctionSymbol(parser->global_symtable, token->symbol_id)) == NULL)
     {
         func = FunctionSymbolInit();
-        func->name = strdup(token->attribute);
+        func->name = InternedName(token->symbol_id);
+        func->symbol_id = token->symbol_id;
         InsertFunctionSymbol(parser, func);
         parser->current_function = func;
     }
@@ -158,12 +161,12 @@ void ParseFunctionDefinition(Parser *parser)
                    parser->line_number, func->name);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_REDEFINED);
     }
 
     // check if the main function is present
-    if (!strcmp(func->name, "main"))
+    if (SYMBOL_IDS_EQUAL(func->symbol_id, main_symbol_id))
     {
         parser->has_main = true;
         is_main = true;
@@ -172,17 +175,16 @@ void ParseFunctionDefinition(Parser *parser)
     token = CheckAndReturnTokenStream(parser, L_ROUND_BRACKET);
     ParseParameters(parser, func); // params with )
 
-    if ((token = LoadTokenFromStream(&parser->line_number))->token_type != KEYWORD ||
+    if ((token = ScanToken(&parser->line_number))->token_type != KEYWORD ||
         (token->keyword_type != I32 && token->keyword_type != F64 && token->keyword_type != U8 && token->keyword_type != VOID))
     {
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyToken(token);
-        DestroyTokenVector(stream);
+        DestroyStream();
         ErrorExit(ERROR_SYNTACTIC, "Expected data type at line %d", parser->line_number);
     }
 
-    AppendToken(stream, token);
+    StreamAppendToken(stream, token);
 
     // set the return type
     switch (token->keyword_type)
@@ -204,9 +206,9 @@ void ParseFunctionDefinition(Parser *parser)
     // Check for correct return type/params in case of main
     if (is_main && (func->return_type != VOID_TYPE || func->num_of_parameters != 0))
     {
-        DestroySymtable(parser->global_symtable);
         SymtableStackDestroy(parser->symtable_stack);
-        DestroyTokenVector(stream);
+        DestroySymtable(parser->global_symtable);
+        DestroyStream();
         ErrorExit(ERROR_SEMANTIC_TYPECOUNT_FUNCTION, "Main function has incorrect return type or parameters");
     }
 
@@ -218,37 +220,37 @@ void ParseParameters(Parser *parser, FunctionSymbol *func)
 {
     Token *token;
     int param_count = 0;
+    int param_capacity = 0;
 
     // loops through all parameters
     while (1)
     {
-        token = LoadTokenFromStream(&parser->line_number);
+        token = ScanToken(&parser->line_number);
         if (token->token_type == R_ROUND_BRACKET) // reached ')' so all parameters are checked
         {
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
             break;
         }
 
         if (token->token_type == EOF_TOKEN) // reached EOF without ')'
         {
-            DestroyToken(token);
-            DestroySymtable(parser->symtable);
             SymtableStackDestroy(parser->symtable_stack);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_SYNTACTIC, "Didn't you forget ) at line %d ?", parser->line_number);
         }
 
         // id : data_type
         if (token->token_type == IDENTIFIER_TOKEN)
         {
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
             VariableSymbol *var = VariableSymbolInit();
-            var->name = strdup(token->attribute);
+            var->name = InternedName(token->symbol_id);
+            var->symbol_id = token->symbol_id;
             var->is_const = false;
 
             for (int i = 0; i < func->num_of_parameters; i++)
             {
-                if (!strcmp(func->parameters[i]->name, var->name))
+                if (SYMBOL_IDS_EQUAL(func->parameters[i]->symbol_id, var->symbol_id))
                 {
                     PrintError("Error in semantic analysis: Line %d: Multiple parameters with name '%s' in function '%s'",
                                parser->line_number, var->name, func->name);
@@ -257,7 +259,7 @@ void ParseParameters(Parser *parser, FunctionSymbol *func)
                     SymtableStackDestroy(parser->symtable_stack);
                     DestroySymtable(parser->global_symtable);
                     DestroyVariableSymbol(var);
-                    DestroyTokenVector(stream);
+                    DestroyStream();
 
                     exit(ERROR_SEMANTIC_REDEFINED);
                 }
@@ -266,17 +268,16 @@ void ParseParameters(Parser *parser, FunctionSymbol *func)
             // TODO: possible var leak (???? Explain pls)
             CheckTokenTypeStream(parser, COLON_TOKEN);
 
-            if ((token = LoadTokenFromStream(&parser->line_number))->token_type != KEYWORD && (token->keyword_type != I32 || token->keyword_type != F64 || token->keyword_type != U8))
+            if ((token = ScanToken(&parser->line_number))->token_type != KEYWORD && (token->keyword_type != I32 || token->keyword_type != F64 || token->keyword_type != U8))
             {
-                DestroyToken(token);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 DestroyVariableSymbol(var);
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
                 ErrorExit(ERROR_SYNTACTIC, "Expected data type at line %d", parser->line_number);
             }
 
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
 
             // add parameter data type to the function
             switch (token->keyword_type)
@@ -295,37 +296,40 @@ void ParseParameters(Parser *parser, FunctionSymbol *func)
                 break;
             }
 
-            // add parameter to the function symbol
-            func->parameters = realloc(func->parameters, (param_count + 1) * sizeof(VariableSymbol *));
+            // add parameter to the function symbol, the array is allocated for a few of them at once (most functions don't need more)
+            if (param_count == param_capacity)
+            {
+                param_capacity = param_capacity == 0 ? INITIAL_PARAM_CAPACITY : param_capacity * 2;
+                if ((func->parameters = realloc(func->parameters, param_capacity * sizeof(VariableSymbol *))) == NULL)
+                    ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+            }
             func->parameters[param_count++] = var;
 
             // checks if there is another parameter
-            if ((token = LoadTokenFromStream(&parser->line_number))->token_type != COMMA_TOKEN)
+            if ((token = ScanToken(&parser->line_number))->token_type != COMMA_TOKEN)
             {
                 // no more parameters
                 if (token->token_type == R_ROUND_BRACKET)
                 {
-                    AppendToken(stream, token);
+                    StreamAppendToken(stream, token);
                     break;
                 }
 
                 else
                 {
-                    DestroyToken(token);
-                    DestroyTokenVector(stream);
-                    DestroySymtable(parser->global_symtable);
+                    DestroyStream();
                     SymtableStackDestroy(parser->symtable_stack);
+                    DestroySymtable(parser->global_symtable);
                     ErrorExit(ERROR_SYNTACTIC, "Expected ',' or ')' at line %d", parser->line_number);
                 }
             }
-            AppendToken(stream, token);
+            StreamAppendToken(stream, token);
         }
         else
         {
-            DestroyToken(token);
-            DestroyTokenVector(stream);
-            DestroySymtable(parser->global_symtable);
+            DestroyStream();
             SymtableStackDestroy(parser->symtable_stack);
+            DestroySymtable(parser->global_symtable);
             ErrorExit(ERROR_SYNTACTIC, "Expected identifier at line %d", parser->line_number);
         }
     }
@@ -336,15 +340,18 @@ void ParseParameters(Parser *parser, FunctionSymbol *func)
 void ParseFunctions(Parser *parser)
 {
     // The token vector to store the tokens
-    stream = InitTokenVector();
+    stream = InitTokenStream();
+
+    // With -j, the whole program is scanned on multiple threads first and the loop below just reads the tokens
+    PrescanSource();
 
     // Get the line number of the first token
     Token *token;
 
-    while ((token = LoadTokenFromStream(&parser->line_number))->token_type != EOF_TOKEN)
+    while ((token = ScanToken(&parser->line_number))->token_type != EOF_TOKEN)
     {
         // Reserve the new token
-        AppendToken(stream, token);
+        StreamAppendToken(stream, token);
 
         // Check the nested level
         if (token->token_type == R_CURLY_BRACKET)
@@ -366,7 +373,7 @@ void ParseFunctions(Parser *parser)
             {
                 SymtableStackDestroy(parser->symtable_stack);
                 DestroySymtable(parser->global_symtable);
-                DestroyTokenVector(stream);
+                DestroyStream();
                 ErrorExit(ERROR_SEMANTIC_OTHER, "Line %d: Function definition cannot be nested inside another block!!!",
                           parser->line_number);
             }
@@ -390,11 +397,17 @@ void ParseFunctions(Parser *parser)
             ParseIfWhile(parser);
             parser->nested_level++;
         }
+
+        // Everything loaded so far is in the stream, the Token structs aren't needed anymore
+        RecycleTokens();
     }
 
     // Append the EOF token
-    AppendToken(stream, token);
+    StreamAppendToken(stream, token);
 
     // The line number of the first token
-    parser->line_number = stream->token_string[0]->line_number;
+    parser->line_number = StreamLineNumber(stream, 0);
+
+    // Everything is in the stream now, the second pass builds its own tokens from it
+    RecycleTokens();
 }
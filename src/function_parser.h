@@ -20,6 +20,9 @@
 
 #include "types.h"
 
+// Number of parameters the parameter array of a function is first allocated for, it's doubled if there are more
+#define INITIAL_PARAM_CAPACITY 4
+
 /**
  * @brief Parses a function definition. DOES NOT generate code! That is the core parser's task
  *
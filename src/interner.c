@@ -0,0 +1,166 @@
+/**
+ * @file interner.c
+ * @brief Implementation of the global string interner
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interner.h"
+#include "arena.h"
+#include "error.h"
+
+// Number of hash slots at the start, always a power of two
+#define INTERNER_INITIAL_SLOTS 256
+
+typedef struct
+{
+    const char *name; // NUL-terminated copy in the interner's arena
+    int length;
+    unsigned hash;
+} InternedString;
+
+// strings[id] is the string with the given id, slots are an open addressing table of ids (0 = empty slot)
+static struct
+{
+    InternedString *strings;
+    int count;
+    int capacity;
+    int *slots;
+    unsigned slot_count;
+    Arena names;
+} interner = {NULL, 0, 0, NULL, 0, {NULL}};
+
+#ifdef IFJ24_STATS
+InternerStats interner_stats = {0, 0, 0, 0};
+#endif
+
+// The same sdbm variant the symtables used to hash names with
+static unsigned HashString(const char *string, size_t length)
+{
+    unsigned hash = 0;
+    const unsigned char *p = (const unsigned char *)string;
+    for (size_t i = 0; i < length; i++)
+        hash = 65599 * hash + p[i];
+
+    return hash;
+}
+
+// Returns the slot which either holds the string or is the empty slot where it belongs
+static unsigned FindSlot(const char *string, size_t length, unsigned hash)
+{
+    INTERNER_STAT(interner_stats.lookups++);
+
+    unsigned mask = interner.slot_count - 1;
+    unsigned index = hash & mask;
+
+    int id;
+    while ((id = interner.slots[index]) != 0)
+    {
+        InternedString *entry = &interner.strings[id];
+        if (entry->hash == hash && (size_t)entry->length == length)
+        {
+            INTERNER_STAT(interner_stats.byte_comparisons++);
+            if (memcmp(entry->name, string, length) == 0)
+                return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+// Doubles the number of slots and puts every id back, keeps the load factor under 1/2
+static void GrowSlots(void)
+{
+    unsigned slot_count = interner.slot_count == 0 ? INTERNER_INITIAL_SLOTS : interner.slot_count * 2;
+    int *slots;
+    if ((slots = calloc(slot_count, sizeof(int))) == NULL)
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+    for (int id = 1; id < interner.count; id++)
+    {
+        unsigned index = interner.strings[id].hash & (slot_count - 1);
+        while (slots[index] != 0)
+            index = (index + 1) & (slot_count - 1);
+
+        slots[index] = id;
+    }
+
+    free(interner.slots);
+    interner.slots = slots;
+    interner.slot_count = slot_count;
+}
+
+int InternString(const char *string, size_t length)
+{
+    // id 0 is NO_SYMBOL_ID, so the first entry of the array is never used
+    if (interner.count == 0)
+        interner.count = 1;
+
+    if ((unsigned)interner.count * 2 >= interner.slot_count)
+        GrowSlots();
+
+    unsigned hash = HashString(string, length);
+    unsigned index = FindSlot(string, length, hash);
+    if (interner.slots[index] != 0)
+        return interner.slots[index];
+
+    if (interner.count + 1 > interner.capacity)
+    {
+        interner.capacity = interner.capacity == 0 ? INTERNER_INITIAL_SLOTS : interner.capacity * 2;
+        if ((interner.strings = realloc(interner.strings, interner.capacity * sizeof(InternedString))) == NULL)
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+    }
+
+    INTERNER_STAT(interner_stats.strings++);
+    int id = interner.count++;
+    interner.strings[id] = (InternedString){ArenaCopyString(&interner.names, string, length), length, hash};
+    interner.slots[index] = id;
+
+    return id;
+}
+
+int FindInterned(const char *string, size_t length)
+{
+    if (interner.slot_count == 0)
+        return NO_SYMBOL_ID;
+
+    return interner.slots[FindSlot(string, length, HashString(string, length))];
+}
+
+const char *InternedName(int id)
+{
+    return interner.strings[id].name;
+}
+
+int InternedLength(int id)
+{
+    return interner.strings[id].length;
+}
+
+void ReleaseInterner(void)
+{
+    free(interner.strings);
+    free(interner.slots);
+    ArenaRelease(&interner.names);
+
+    interner.strings = NULL;
+    interner.slots = NULL;
+    interner.count = interner.capacity = 0;
+    interner.slot_count = 0;
+}
+
+#ifdef IFJ24_STATS
+void PrintInternerStats(void)
+{
+    fprintf(stderr, "Interned identifiers: %lu distinct, %lu lookups (%lu memcmp calls)\n",
+            interner_stats.strings, interner_stats.lookups, interner_stats.byte_comparisons);
+    fprintf(stderr, "Name comparisons done on ids instead of strcmp: %lu\n", interner_stats.id_comparisons);
+}
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file interner.h
+ * @brief Global string interner, gives every distinct identifier of the program a dense integer id
+ *
+ * The scanner interns every identifier it reads, so two identifiers with the same name always get the same id.
+ * Symbols are keyed on these ids, which turns every name comparison in the symtables into an integer comparison.
+ * Ids start at 1, NO_SYMBOL_ID (0) belongs to tokens which aren't identifiers.
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stddef.h>
+
+// Id of tokens/symbols without a name, never returned by InternString()
+#define NO_SYMBOL_ID 0
+
+/**
+ * @brief Returns the id of the string, adding it to the interner if it isn't there yet
+ *
+ * @param string The characters to intern, don't have to be NUL-terminated
+ * @param length Number of characters
+ * @return int Id of the string, the same for every call with equal strings
+ */
+int InternString(const char *string, size_t length);
+
+// Like InternString(), but never adds the string, returns NO_SYMBOL_ID if it wasn't interned yet
+int FindInterned(const char *string, size_t length);
+
+// NUL-terminated copy of the string with the given id, valid until ReleaseInterner()
+const char *InternedName(int id);
+
+// Length of the string with the given id
+int InternedLength(int id);
+
+// Frees every interned string, the ids handed out so far become invalid
+void ReleaseInterner(void);
+
+// The counters are only there with make STATS=1 (-DIFJ24_STATS), like the symtable's
+
+#ifdef IFJ24_STATS
+/**
+ * @brief Counters of the name comparisons done on ids instead of strcmp() and of the work the interning itself costs
+ *
+ * Only incremented, printed to stderr with PrintInternerStats() together with the symtable's when the compiler exits
+ */
+typedef struct
+{
+    unsigned long id_comparisons;   // Name comparisons which would have been a strcmp()/strncmp() without the interner
+    unsigned long strings;          // Distinct strings interned
+    unsigned long lookups;          // Calls of InternString()/FindInterned()
+    unsigned long byte_comparisons; // memcmp() calls done by the interner on a hash match
+} InternerStats;
+
+extern InternerStats interner_stats;
+
+#define INTERNER_STAT(statement) \
+    do                           \
+    {                            \
+        statement;               \
+    } while (0)
+
+// Compares two symbol ids, counting the comparison as one strcmp() saved
+#define SYMBOL_IDS_EQUAL(a, b) (++interner_stats.id_comparisons, (a) == (b))
+
+// Prints the interner counters to stderr
+void PrintInternerStats(void);
+#else
+#define INTERNER_STAT(statement) \
+    do                           \
+    {                            \
+    } while (0)
+
+// Compares two symbol ids, a plain integer comparison without the counters
+#define SYMBOL_IDS_EQUAL(a, b) ((a) == (b))
+#endif
+
+#endif
@@ -24,6 +24,7 @@
 #include "stack.h"
 #include "symtable.h"
 #include "vector.h"
+#include "interner.h"
 
 bool IsLoopNullableType(Parser *parser)
 {
@@ -58,7 +59,7 @@ bool IsLoopNullableType(Parser *parser)
         case EOF_TOKEN:
             SymtableStackDestroy(parser->symtable_stack);
             DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
+            DestroyStream();
             ErrorExit(ERROR_SYNTACTIC, "Line %d: Incorrectly ended while loop", parser->line_number);
             break; // gcc would complain about missing break, but it's not needed here
 
@@ -97,12 +98,12 @@ void ParseWhileLoop(Parser *parser)
 
     // Parse the expression
     TokenVector *postfix = InfixToPostfix(parser);
-    DATA_TYPE expr_type = ParseExpression(postfix, parser);
+    DATA_TYPE expr_type = ParseExpression(postfix, parser, NULL);
 
     // Check if the expression wasn't of a incorrect type
     if (expr_type != BOOLEAN)
     {
-        DestroyTokenVector(stream);
+        DestroyStream();
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
         ErrorExit(ERROR_SEMANTIC_TYPE_COMPATIBILITY, "Line %d: Expected boolean expression in while loop", parser->line_number);
@@ -150,13 +151,13 @@ void ParseNullableWhileLoop(Parser *parser)
     Token *token = CheckAndReturnTokenVector(parser, IDENTIFIER_TOKEN);
 
     // Check if it's a defined variable
-    VariableSymbol *var = SymtableStackFindVariable(parser->symtable_stack, token->attribute);
+    VariableSymbol *var = SymtableStackFindVariable(parser->symtable_stack, token->symbol_id);
     if (var == NULL)
     {
-        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%s\"", token->attribute);
+        PrintError("Error in semantic analysis: Line %d: Undefined variable \"%.*s\"", parser->line_number, token->length, token->attribute);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_UNDEFINED);
     }
 
@@ -165,7 +166,7 @@ void ParseNullableWhileLoop(Parser *parser)
         PrintError("Error in semantic analysis: Line %d: Variable \"%s\" is not of a nullable type", var->name);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
+        DestroyStream();
         exit(ERROR_SEMANTIC_TYPE_COMPATIBILITY);
     }
     var->was_used = true;
@@ -191,7 +192,8 @@ void ParseNullableWhileLoop(Parser *parser)
     VariableSymbol *var2 = VariableSymbolInit();
     var2->defined = true;
     var2->is_const = false;
-    var2->name = strdup(token->attribute);
+    var2->name = InternedName(token->symbol_id);
+    var2->symbol_id = token->symbol_id;
     var2->type = NullableToNormal(var->type);
 
     // Closing '|'
@@ -0,0 +1,213 @@
+/**
+ * @file parallel_scan.c
+ * @brief Implementation of the parallel scanning of very large programs
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parallel_scan.h"
+#include "scanner.h"
+#include "vector.h"
+#include "interner.h"
+#include "error.h"
+
+static int scan_threads = 1;
+
+// The scanned chunks, ScanToken() reads the token next of chunk current
+static struct
+{
+    SourceChunk *chunks;
+    int count;
+    int current;
+    int next;
+    int first_line; // Line the current chunk starts on
+    const char *data;
+    size_t length;
+} prescan = {NULL, 0, 0, 0, 1, NULL, 0};
+
+void SetScanThreads(int threads)
+{
+    if (threads == 0)
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    scan_threads = threads < 1 ? 1 : threads;
+}
+
+// Whitespace the scanner skips before the '\\' of a multiline literal line, so everything but '\n'
+static bool IsLineSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Returns the start of the first line after position which doesn't continue a multiline literal, or length if there is none
+static size_t FindChunkBoundary(const char *data, size_t length, size_t position)
+{
+    const char *newline;
+    while (position < length && (newline = memchr(data + position, '\n', length - position)) != NULL)
+    {
+        position = newline - data + 1;
+
+        // a line starting with \\ can be the next line of a literal, the scanner is between two tokens on any other one
+        size_t i = position;
+        while (i < length && IsLineSpace(data[i]))
+            i++;
+
+        if (i + 1 >= length || data[i] != '\\' || data[i + 1] != '\\')
+            return position;
+    }
+
+    return length;
+}
+
+static void *ScanWorker(void *argument)
+{
+    SourceChunk *chunk = argument;
+    ScanSourceChunk(chunk, prescan.data, prescan.length);
+
+    // the lines of the chunk are needed to know which line the next chunk starts on
+    const char *newline = prescan.data + chunk->start;
+    const char *end = prescan.data + chunk->end;
+    chunk->newlines = 0;
+    while ((newline = memchr(newline, '\n', end - newline)) != NULL)
+    {
+        chunk->newlines++;
+        newline++;
+    }
+
+    return NULL;
+}
+
+// Frees a scanned chunk, its attributes aren't freed since they were adopted by the main thread's scanner
+static void DestroyChunk(SourceChunk *chunk)
+{
+    if (chunk->tokens != NULL)
+        DestroyTokenStream(chunk->tokens);
+    free(chunk->scan_lines);
+
+    chunk->tokens = NULL;
+    chunk->scan_lines = NULL;
+}
+
+void PrescanSource(void)
+{
+    prescan.data = SourceData(&prescan.length);
+
+    size_t count = prescan.length / PARALLEL_SCAN_MIN_CHUNK;
+    if (count > (size_t)scan_threads)
+        count = scan_threads;
+
+    if (count < 2)
+        return;
+
+    if ((prescan.chunks = calloc(count, sizeof(SourceChunk))) == NULL)
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+    // chunks of roughly the same size, a boundary is moved forward to the next line the scanner can start on
+    size_t start = 0;
+    for (size_t i = 1; i < count && start < prescan.length; i++)
+    {
+        size_t target = prescan.length / count * i;
+        size_t boundary = FindChunkBoundary(prescan.data, prescan.length, target > start ? target : start);
+        if (boundary >= prescan.length)
+            break;
+
+        prescan.chunks[prescan.count++] = (SourceChunk){.start = start, .end = boundary};
+        start = boundary;
+    }
+
+    prescan.chunks[prescan.count++] = (SourceChunk){.start = start, .end = prescan.length};
+
+    pthread_t *threads;
+    if ((threads = malloc(prescan.count * sizeof(pthread_t))) == NULL)
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+    for (int i = 0; i < prescan.count; i++)
+    {
+        if (pthread_create(&threads[i], NULL, ScanWorker, &prescan.chunks[i]) != 0)
+            ErrorExit(ERROR_INTERNAL, "Failed to start a scanner thread");
+    }
+
+    for (int i = 0; i < prescan.count; i++)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+
+    for (int i = 0; i < prescan.count; i++)
+        AdoptChunkAttributes(&prescan.chunks[i]);
+
+    // the serial scanner only scans something if one of the chunks has a lexical error, it starts from there then
+    SeekSource(prescan.length);
+}
+
+// Builds the token at index of the chunk the way the serial scanner would have returned it
+static Token *ChunkToken(SourceChunk *chunk, int index, int *line_number)
+{
+    Token *token = StreamToken(chunk->tokens, index);
+
+    // identifiers of a chunk come with their text, they are interned here, in the order of the source,
+    // so every one of them gets the id it would get without the chunks
+    if (token->token_type == IDENTIFIER_TOKEN)
+    {
+        token->symbol_id = InternString(token->attribute, token->length);
+        token->attribute = InternedName(token->symbol_id);
+    }
+
+    // some tokens are returned without a line (0), the others are moved from the chunk's lines to the program's
+    if (token->line_number != 0)
+        token->line_number += prescan.first_line - 1;
+    *line_number = chunk->scan_lines[index] + prescan.first_line - 1;
+
+    return token;
+}
+
+Token *ScanToken(int *line_number)
+{
+    while (prescan.current < prescan.count)
+    {
+        SourceChunk *chunk = &prescan.chunks[prescan.current];
+        if (prescan.next < chunk->tokens->length)
+        {
+            Token *token = ChunkToken(chunk, prescan.next++, line_number);
+
+            // the first chunk which reaches the end of the source has the EOF token, the ones after it have nothing else
+            if (token->token_type == EOF_TOKEN)
+                ReleasePrescan();
+
+            return token;
+        }
+
+        // the chunks after a lexical error are thrown away, the serial scanner continues from the faulty token
+        if (chunk->failed)
+        {
+            SeekSource(chunk->error_position);
+            *line_number = chunk->error_line + prescan.first_line - 1;
+            ReleasePrescan();
+            break;
+        }
+
+        prescan.first_line += chunk->newlines;
+        prescan.current++;
+        prescan.next = 0;
+        DestroyChunk(chunk);
+    }
+
+    return LoadTokenFromStream(line_number);
+}
+
+void ReleasePrescan(void)
+{
+    for (int i = prescan.current; i < prescan.count; i++)
+        DestroyChunk(&prescan.chunks[i]);
+
+    free(prescan.chunks);
+    prescan.chunks = NULL;
+    prescan.count = prescan.current = prescan.next = 0;
+    prescan.first_line = 1;
+}
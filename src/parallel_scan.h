@@ -0,0 +1,49 @@
+/**
+ * @file parallel_scan.h
+ * @brief Optional parallel scanning of very large programs
+ *
+ * With more than one scan thread set (the -j option), the source is split into chunks at line starts which can't be
+ * inside a multiline literal, and every chunk is scanned on its own thread before the first pass starts.
+ * The first pass then reads the tokens of the chunks in order through ScanToken(), which also interns the identifiers,
+ * so the token stream, the line numbers and the identifier ids are exactly the ones the serial scanner would produce.
+ * A lexical error in a chunk is reported by the serial scanner, which continues from the faulty token.
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#ifndef PARALLEL_SCAN_H
+#define PARALLEL_SCAN_H
+
+#include "types.h"
+
+// Programs are only split into chunks of at least this many bytes, smaller ones aren't worth starting a thread for
+#ifndef PARALLEL_SCAN_MIN_CHUNK
+#define PARALLEL_SCAN_MIN_CHUNK (256 * 1024)
+#endif
+
+// Most threads -j accepts
+#define PARALLEL_SCAN_MAX_THREADS 1024
+
+// Sets the number of threads the source is scanned on (1 by default, which is the serial scanner), 0 means one per CPU
+void SetScanThreads(int threads);
+
+/**
+ * @brief Scans the whole loaded source on the scan threads, does nothing with a single thread or a small program
+ *
+ * @note Has to be called after LoadSource() and before the first ScanToken()
+ */
+void PrescanSource(void);
+
+/**
+ * @brief Returns the next token of the source, the first pass uses this instead of LoadTokenFromStream()
+ *
+ * @param line_number The scanner's line counter, set to the value the serial scanner would have after the token
+ * @return Token* The token, either one of the prescanned ones or a freshly scanned one
+ */
+Token *ScanToken(int *line_number);
+
+// Frees the chunks which haven't been read by ScanToken() yet
+void ReleasePrescan(void);
+
+#endif
@@ -11,66 +11,422 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "scanner.h"
 #include "error.h"
 #include "vector.h"
+#include "simd_scan.h"
+#include "arena.h"
+#include "interner.h"
 
-Token *InitToken()
+// Size of the first chunk read from a non-seekable input, doubled whenever it fills up
+#define SOURCE_CHUNK 65536
+
+/* The scanner state is per thread, so that the threads of the parallel scanner (see parallel_scan.h) can each scan a chunk
+of the source. The main thread is the only one which uses it outside of ScanSourceChunk() */
+
+// The program being compiled, the scanner only moves a cursor over it
+static _Thread_local SourceBuffer source = {NULL, 0, 0, false};
+
+// Owns every Token, RecycleTokens() reuses it once the tokens aren't referenced anymore
+static _Thread_local Arena token_arena = {NULL};
+
+// Owns every attribute which isn't a view into the source, these live until ReleaseTokens() since the token stream refers to them
+static _Thread_local Arena attribute_arena = {NULL};
+
+// Reused for building escaped/multiline literals and for converting numbers, so that they don't need a buffer each
+static _Thread_local Vector scratch = {0, 0, NULL};
+
+// Set while ScanSourceChunk() runs, a lexical error jumps back there instead of exiting (the main thread reports it later)
+static _Thread_local jmp_buf *chunk_abort = NULL;
+
+// Where the token being scanned starts and the line it starts on, a chunk uses it to stop at its end
+static _Thread_local size_t token_start = 0;
+static _Thread_local int token_start_line = 0;
+
+// Gives up on the current chunk if a thread of the parallel scanner is scanning one, does nothing otherwise
+static void AbortChunk(void)
 {
-    Token *token;
-    if ((token = calloc(1, sizeof(Token))) == NULL)
+    if (chunk_abort != NULL)
+        longjmp(*chunk_abort, 1);
+}
+
+// Every lexical error goes through this, so that a chunk can be abandoned before anything is printed
+#define LEXICAL_ERROR(...)                       \
+    do                                           \
+    {                                            \
+        AbortChunk();                            \
+        ErrorExit(ERROR_LEXICAL, __VA_ARGS__);   \
+    } while (0)
+
+// Cursor primitives over the source buffer, they behave like getchar()/ungetc() did, so EOF is never consumed or pushed back
+#define GET_CHAR() (source.position < source.length ? (unsigned char)source.data[source.position++] : EOF)
+#define UNGET_CHAR(c)              \
+    do                             \
+    {                              \
+        if ((c) != EOF)            \
+            --source.position;     \
+    } while (0)
+#define PEEK_CHAR(offset) (source.position + (offset) < source.length ? (unsigned char)source.data[source.position + (offset)] : EOF)
+
+// Class of every possible input byte, the bytes which aren't listed are CLASS_INVALID (0)
+static const unsigned char char_classes[256] = {
+    // numbers
+    ['0'] = CLASS_ZERO, ['1'] = CLASS_DIGIT, ['2'] = CLASS_DIGIT, ['3'] = CLASS_DIGIT, ['4'] = CLASS_DIGIT,
+    ['5'] = CLASS_DIGIT, ['6'] = CLASS_DIGIT, ['7'] = CLASS_DIGIT, ['8'] = CLASS_DIGIT, ['9'] = CLASS_DIGIT,
+    // letters, e/E have their own class since they can also be a part of a number
+    ['a'] = CLASS_LETTER, ['b'] = CLASS_LETTER, ['c'] = CLASS_LETTER, ['d'] = CLASS_LETTER, ['e'] = CLASS_EXPONENT,
+    ['f'] = CLASS_LETTER, ['g'] = CLASS_LETTER, ['h'] = CLASS_LETTER, ['i'] = CLASS_LETTER, ['j'] = CLASS_LETTER,
+    ['k'] = CLASS_LETTER, ['l'] = CLASS_LETTER, ['m'] = CLASS_LETTER, ['n'] = CLASS_LETTER, ['o'] = CLASS_LETTER,
+    ['p'] = CLASS_LETTER, ['q'] = CLASS_LETTER, ['r'] = CLASS_LETTER, ['s'] = CLASS_LETTER, ['t'] = CLASS_LETTER,
+    ['u'] = CLASS_LETTER, ['v'] = CLASS_LETTER, ['w'] = CLASS_LETTER, ['x'] = CLASS_LETTER, ['y'] = CLASS_LETTER,
+    ['z'] = CLASS_LETTER,
+    ['A'] = CLASS_LETTER, ['B'] = CLASS_LETTER, ['C'] = CLASS_LETTER, ['D'] = CLASS_LETTER, ['E'] = CLASS_EXPONENT,
+    ['F'] = CLASS_LETTER, ['G'] = CLASS_LETTER, ['H'] = CLASS_LETTER, ['I'] = CLASS_LETTER, ['J'] = CLASS_LETTER,
+    ['K'] = CLASS_LETTER, ['L'] = CLASS_LETTER, ['M'] = CLASS_LETTER, ['N'] = CLASS_LETTER, ['O'] = CLASS_LETTER,
+    ['P'] = CLASS_LETTER, ['Q'] = CLASS_LETTER, ['R'] = CLASS_LETTER, ['S'] = CLASS_LETTER, ['T'] = CLASS_LETTER,
+    ['U'] = CLASS_LETTER, ['V'] = CLASS_LETTER, ['W'] = CLASS_LETTER, ['X'] = CLASS_LETTER, ['Y'] = CLASS_LETTER,
+    ['Z'] = CLASS_LETTER,
+    // whitespace
+    [' '] = CLASS_WHITESPACE, ['\t'] = CLASS_WHITESPACE, ['\n'] = CLASS_WHITESPACE,
+    ['\v'] = CLASS_WHITESPACE, ['\f'] = CLASS_WHITESPACE, ['\r'] = CLASS_WHITESPACE,
+    // everything else that can start a token
+    ['_'] = CLASS_UNDERSCORE, ['"'] = CLASS_QUOTE, ['\\'] = CLASS_BACKSLASH, ['/'] = CLASS_SLASH,
+    ['='] = CLASS_EQUALS, ['<'] = CLASS_LESS, ['>'] = CLASS_GREATER, ['!'] = CLASS_EXCLAMATION,
+    ['?'] = CLASS_QUESTION, ['['] = CLASS_L_SQUARE, ['@'] = CLASS_AT, ['.'] = CLASS_DOT,
+    ['+'] = CLASS_PLUS, ['-'] = CLASS_MINUS, ['*'] = CLASS_ASTERISK, ['('] = CLASS_L_ROUND,
+    [')'] = CLASS_R_ROUND, ['{'] = CLASS_L_CURLY, ['}'] = CLASS_R_CURLY, ['|'] = CLASS_VERTICAL_BAR,
+    [';'] = CLASS_SEMICOLON, [':'] = CLASS_COLON, [','] = CLASS_COMMA,
+};
+
+// First transition of the DFA, the state it enters after the first character of a token
+static const SCANNER_STATE start_states[CLASS_COUNT] = {
+    [CLASS_INVALID] = STATE_INVALID,
+    [CLASS_DIGIT] = STATE_NUMBER,
+    [CLASS_ZERO] = STATE_ZERO,
+    [CLASS_LETTER] = STATE_IDENTIFIER,
+    [CLASS_EXPONENT] = STATE_IDENTIFIER,
+    [CLASS_UNDERSCORE] = STATE_IDENTIFIER,
+    [CLASS_WHITESPACE] = STATE_WHITESPACE,
+    [CLASS_QUOTE] = STATE_LITERAL,
+    [CLASS_BACKSLASH] = STATE_MULTILINE_LITERAL,
+    [CLASS_SLASH] = STATE_SLASH,
+    [CLASS_EQUALS] = STATE_OPERATOR,
+    [CLASS_LESS] = STATE_OPERATOR,
+    [CLASS_GREATER] = STATE_OPERATOR,
+    [CLASS_EXCLAMATION] = STATE_OPERATOR,
+    [CLASS_QUESTION] = STATE_PREFIX,
+    [CLASS_L_SQUARE] = STATE_U8,
+    [CLASS_AT] = STATE_IMPORT,
+    [CLASS_DOT] = STATE_SINGLE_CHAR,
+    [CLASS_PLUS] = STATE_SINGLE_CHAR,
+    [CLASS_MINUS] = STATE_SINGLE_CHAR,
+    [CLASS_ASTERISK] = STATE_SINGLE_CHAR,
+    [CLASS_L_ROUND] = STATE_SINGLE_CHAR,
+    [CLASS_R_ROUND] = STATE_SINGLE_CHAR,
+    [CLASS_L_CURLY] = STATE_SINGLE_CHAR,
+    [CLASS_R_CURLY] = STATE_SINGLE_CHAR,
+    [CLASS_VERTICAL_BAR] = STATE_SINGLE_CHAR,
+    [CLASS_SEMICOLON] = STATE_SINGLE_CHAR,
+    [CLASS_COLON] = STATE_SINGLE_CHAR,
+    [CLASS_COMMA] = STATE_SINGLE_CHAR,
+};
+
+// Accepted token for the STATE_SINGLE_CHAR classes
+static const TOKEN_TYPE single_char_tokens[CLASS_COUNT] = {
+    [CLASS_DOT] = DOT_TOKEN,
+    [CLASS_PLUS] = ADDITION_OPERATOR,
+    [CLASS_MINUS] = SUBSTRACTION_OPERATOR,
+    [CLASS_ASTERISK] = MULTIPLICATION_OPERATOR,
+    [CLASS_L_ROUND] = L_ROUND_BRACKET,
+    [CLASS_R_ROUND] = R_ROUND_BRACKET,
+    [CLASS_L_CURLY] = L_CURLY_BRACKET,
+    [CLASS_R_CURLY] = R_CURLY_BRACKET,
+    [CLASS_VERTICAL_BAR] = VERTICAL_BAR_TOKEN,
+    [CLASS_SEMICOLON] = SEMICOLON,
+    [CLASS_COLON] = COLON_TOKEN,
+    [CLASS_COMMA] = COMMA_TOKEN,
+};
+
+// Accepted token for the STATE_OPERATOR classes, the second index is 1 if the operator is followed by a '=' ('!' alone is an error)
+static const TOKEN_TYPE operator_tokens[CLASS_COUNT][2] = {
+    [CLASS_EQUALS] = {ASSIGNMENT, EQUAL_OPERATOR},
+    [CLASS_LESS] = {LESS_THAN_OPERATOR, LESSER_EQUAL_OPERATOR},
+    [CLASS_GREATER] = {LARGER_THAN_OPERATOR, LARGER_EQUAL_OPERATOR},
+    [CLASS_EXCLAMATION] = {NOT_EQUAL_OPERATOR, NOT_EQUAL_OPERATOR},
+};
+
+// Sets of classes as bitmasks, so that checking if a character belongs to one is a single lookup
+#define CLASS_SET(class) (1u << (class))
+#define DIGIT_CLASSES (CLASS_SET(CLASS_DIGIT) | CLASS_SET(CLASS_ZERO))
+#define ALNUM_CLASSES (DIGIT_CLASSES | CLASS_SET(CLASS_LETTER) | CLASS_SET(CLASS_EXPONENT))
+#define IDENTIFIER_CLASSES (ALNUM_CLASSES | CLASS_SET(CLASS_UNDERSCORE))
+#define NUMBER_CLASSES (DIGIT_CLASSES | CLASS_SET(CLASS_DOT) | CLASS_SET(CLASS_EXPONENT))
+
+// Replacements for the ctype functions, EOF ends up as byte 255 which is CLASS_INVALID
+#define CHAR_CLASS_OF(c) ((CHAR_CLASS)char_classes[(unsigned char)(c)])
+#define CHAR_IN(c, classes) ((CLASS_SET(CHAR_CLASS_OF(c)) & (classes)) != 0)
+#define IS_DIGIT(c) CHAR_IN(c, DIGIT_CLASSES)
+#define IS_ALNUM(c) CHAR_IN(c, ALNUM_CLASSES)
+#define IS_IDENTIFIER_CHAR(c) CHAR_IN(c, IDENTIFIER_CLASSES)
+#define IS_SPACE(c) (CHAR_CLASS_OF(c) == CLASS_WHITESPACE)
+
+void LoadSource(const char *path)
+{
+    // the vectorized helpers are picked once, before the first character is scanned
+    SelectScanFunctions();
+
+    int fd = STDIN_FILENO;
+    if (path != NULL && (fd = open(path, O_RDONLY)) == -1)
+        ErrorExit(ERROR_INTERNAL, "Failed to open the source file %s", path);
+
+    // A regular file can be mapped as a whole, as long as nothing has been read from it yet
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && lseek(fd, 0, SEEK_CUR) == 0)
+    {
+        source.length = info.st_size;
+        if (source.length == 0)
+        {
+            if (fd != STDIN_FILENO)
+                close(fd);
+            return;
+        }
+
+        void *data = mmap(NULL, source.length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, source.length, MADV_SEQUENTIAL);
+            source.data = data;
+            source.is_mapped = true;
+
+            if (fd != STDIN_FILENO)
+                close(fd);
+            return;
+        }
+    }
+
+    // Pipes, terminals or a failed mmap(), read everything into one buffer instead
+    size_t capacity = SOURCE_CHUNK;
+    char *buffer;
+    if ((buffer = malloc(capacity)) == NULL)
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+    source.length = 0;
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, buffer + source.length, capacity - source.length)) != 0)
     {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed.");
+        if (bytes_read == -1)
+        {
+            free(buffer);
+            ErrorExit(ERROR_INTERNAL, "Failed to read the source program");
+        }
+
+        source.length += bytes_read;
+        if (source.length == capacity)
+        {
+            char *tmp;
+            if ((tmp = realloc(buffer, capacity *= 2)) == NULL)
+            {
+                free(buffer);
+                ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+            }
+
+            buffer = tmp;
+        }
     }
 
+    if (fd != STDIN_FILENO)
+        close(fd);
+
+    source.data = buffer;
+}
+
+void DestroySource()
+{
+    if (source.is_mapped)
+        munmap((void *)source.data, source.length);
+    else
+        free((void *)source.data);
+
+    source.data = NULL;
+    source.length = source.position = 0;
+    source.is_mapped = false;
+
+    free(scratch.value);
+    scratch = (Vector){0, 0, NULL};
+}
+
+Token *InitToken()
+{
+    Token *token = ArenaAlloc(&token_arena, sizeof(Token));
+
     // set default value and return
-    token->keyword_type = NONE;
+    *token = (Token){.keyword_type = NONE};
     return token;
 }
 
 Token *CopyToken(Token *token)
 {
-    Token *copy = InitToken();
-
-    copy->attribute = strdup(token->attribute);
-    copy->token_type = token->token_type;
-    copy->keyword_type = token->keyword_type;
-    copy->line_number = token->line_number;
+    // attributes are never modified or freed on their own, so the copy can share them
+    Token *copy = ArenaAlloc(&token_arena, sizeof(Token));
+    *copy = *token;
 
     return copy;
 }
 
-void DestroyToken(Token *token)
+void ReleaseTokens()
 {
-    if (token->attribute != NULL)
+    ArenaRelease(&token_arena);
+    ArenaRelease(&attribute_arena);
+    ReleaseInterner();
+}
+
+void RecycleTokens()
+{
+    ArenaReset(&token_arena);
+}
+
+void SetTokenAttribute(Token *token, const char *attribute)
+{
+    if (attribute == NULL)
     {
-        free(token->attribute);
         token->attribute = NULL;
+        token->length = 0;
+        return;
     }
 
-    free(token);
-    token = NULL;
+    token->length = strlen(attribute);
+    token->attribute = ArenaCopyString(&attribute_arena, attribute, token->length);
+}
+
+bool AttributeEquals(Token *token, const char *string)
+{
+    // lengths first, attributes of a different length are rejected without looking at a single character
+    size_t length = strlen(string);
+    return token->attribute != NULL && (size_t)token->length == length && memcmp(token->attribute, string, length) == 0;
+}
+
+char *AttributeToString(Token *token)
+{
+    char *string;
+    if ((string = malloc(token->length + 1)) == NULL)
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+
+    if (token->length != 0)
+        memcpy(string, token->attribute, token->length);
+    string[token->length] = '\0';
+
+    return string;
+}
+
+// Makes the attribute a view of length characters of the source, starting at offset
+static void SetAttributeView(Token *token, size_t offset, int length)
+{
+    token->attribute = source.data + offset;
+    token->length = length;
+}
+
+// For literals which can't be a view into the source, copies the string built in the scratch vector to the arena
+static void SetAttributeFromScratch(Token *token)
+{
+    // not a strcpy, a \x00 escape sequence can put a '\0' inside the literal
+    token->attribute = ArenaCopyString(&attribute_arena, scratch.value, scratch.length);
+    token->length = scratch.length;
 }
 
 char NextChar()
 {
-    int c = getchar();
-    ungetc(c, stdin);
-    return c;
+    return PEEK_CHAR(0);
 }
 
-CHAR_TYPE GetCharType(char c)
+// Every power of ten up to 10^22 is exactly representable as a double
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Value of a decimal integer literal, saturated at INT64_MAX (an i32 that big is rejected by the interpreter anyway)
+static int64_t ParseInteger(const char *digits, int length)
 {
-    if (isdigit(c))
-        return NUMBER;
-    if (isalpha(c) || c == '_')
-        return CHARACTER;
-    if (isspace(c))
-        return WHITESPACE;
-    return OTHER;
+    int64_t value = 0;
+    for (int i = 0; i < length && IS_DIGIT(digits[i]); i++)
+    {
+        if (value > (INT64_MAX - (digits[i] - '0')) / 10)
+            return INT64_MAX;
+
+        value = value * 10 + (digits[i] - '0');
+    }
+
+    return value;
+}
+
+/**
+ * @brief Value of a float literal, the same as strtod() would return for it (correctly rounded)
+ *
+ * Like strtod(), only the longest valid prefix is parsed ("1e5e5" is 1e5). If the significant digits fit into
+ * 2^53 and the exponent into 10^22, both are exact doubles and the one multiplication/division rounds correctly
+ * (Clinger's fast path), which covers virtually every literal a program contains. Anything else goes to strtod().
+ */
+static double ParseDouble(const char *digits, int length)
+{
+    uint64_t mantissa = 0;
+    int significant_digits = 0, exponent = 0, i = 0;
+    bool exact = true;
+
+    // digits before and after the '.', leading zeroes aren't significant
+    for (bool fraction = false; i < length && (IS_DIGIT(digits[i]) || (digits[i] == '.' && !fraction)); i++)
+    {
+        if (digits[i] == '.')
+        {
+            fraction = true;
+            continue;
+        }
+
+        if (mantissa != 0 || digits[i] != '0')
+        {
+            if (++significant_digits > 19)
+                exact = false;
+            else
+                mantissa = mantissa * 10 + (digits[i] - '0');
+        }
+
+        exponent -= fraction;
+    }
+
+    // an exponent only counts if it has at least one digit
+    int exponent_start = i + 1 + (i + 1 < length && (digits[i + 1] == '+' || digits[i + 1] == '-'));
+    if (i < length && (digits[i] == 'e' || digits[i] == 'E') && exponent_start < length && IS_DIGIT(digits[exponent_start]))
+    {
+        int written_exponent = 0;
+        for (i = exponent_start; i < length && IS_DIGIT(digits[i]); i++)
+        {
+            if (written_exponent < 100000) // past this the result is 0/inf, the exact value doesn't matter
+                written_exponent = written_exponent * 10 + (digits[i] - '0');
+        }
+
+        exponent += digits[exponent_start - 1] == '-' ? -written_exponent : written_exponent;
+    }
+
+    if (exact && mantissa == 0)
+        return 0.0;
+
+    if (exact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    {
+        return exponent < 0 ? (double)mantissa / exact_powers_of_ten[-exponent]
+                            : (double)mantissa * exact_powers_of_ten[exponent];
+    }
+
+    // strtod() needs a terminated string, and the source doesn't have to be terminated after the number
+    scratch.length = 0;
+    AppendChars(&scratch, digits, length);
+    AppendChar(&scratch, '\0');
+    return strtod(scratch.value, NULL);
 }
 
 void ConsumeNumber(Token *token, int *line_number)
@@ -78,9 +434,8 @@ void ConsumeNumber(Token *token, int *line_number)
     // tracking variable
     int c;
 
-    // vector to put the string value of the token and int/doubles to put the actual value
-    // if the numbers ends up being a float, we save it as an string (since it can have an exponent, which C doesn't support so we can't save by value)
-    Vector *vector = InitVector();
+    // the number's characters are left in the source, the token only remembers where they start
+    size_t start = source.position;
 
     // boolean values to check which parts the number has (if it's a floating point number)
     // valid float construction: 3.14, or 3e-2 or 3e+2 or 3e2 or 3.14e-2 or 3.14e+2 or 3.14e2
@@ -90,7 +445,7 @@ void ConsumeNumber(Token *token, int *line_number)
     token->token_type = INTEGER_32;
 
     // TODO: zeroes at the start of the part of a number that is whole are invalid
-    while (isdigit((c = getchar())) || c == '.' || tolower(c) == 'e')
+    while (CHAR_IN((c = GET_CHAR()), NUMBER_CLASSES))
     { // number can be int/double (double has a '.')
         if (c == '.')
         { // check if we already have a floating point value (in case of doubles)
@@ -99,32 +454,26 @@ void ConsumeNumber(Token *token, int *line_number)
             if (!has_floating_point)
             {
                 token->token_type = DOUBLE_64;
-                AppendChar(vector, c);
                 has_floating_point = true;
             }
 
             else
             {
                 /*Don't use ErrorExit(here since we need to free memory AFTER printing the message)*/
-                AppendChar(vector, '\0'); // terminate the string for printing
-                fprintf(stderr, "Line %d: Invalid token %s.\n", *line_number, vector->value);
-
-                // free all allocated resources
-                DestroyToken(token);
-                DestroyVector(vector);
-
+                AbortChunk();
+                fprintf(stderr, "Line %d: Invalid token %.*s.\n", *line_number, (int)(source.position - 1 - start), source.data + start);
                 exit(ERROR_LEXICAL);
             }
         }
 
         // do the same for the exponent part
         // we need to break the loop if the exponent ends, since it's always at the end
-        else if (tolower(c) == 'e')
+        else if (CHAR_CLASS_OF(c) == CLASS_EXPONENT)
         {
             if (!has_exponent)
             {
-                ungetc(c, stdin);
-                if (!ConsumeExponent(vector, token, has_floating_point))
+                UNGET_CHAR(c);
+                if (!ConsumeExponent(token, has_floating_point))
                 {
                     break;
                 }
@@ -134,52 +483,34 @@ void ConsumeNumber(Token *token, int *line_number)
             }
         }
 
-        // c is a number
-        else
-            AppendChar(vector, c);
+        // c is a number, it stays in the source
     }
 
-    // terminate the vector
-    AppendChar(vector, '\0');
-
     // c is the first character after the number, so put it back to the stream
-    ungetc(c, stdin);
-
-    // Sprintf to a string
-    if (token->token_type == DOUBLE_64)
-    {
-        double float_res = strtod(vector->value, NULL);
-        unsigned long length = snprintf(NULL, 0, "%lf", float_res);
-        if ((token->attribute = malloc((length + 1) * sizeof(char))) == NULL)
-            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+    UNGET_CHAR(c);
 
-        sprintf(token->attribute, "%lf", float_res);
-        DestroyVector(vector);
-        return;
-    }
+    int length = source.position - start;
 
-    // copy the number to the token's value
-    if ((token->attribute = malloc(vector->length * sizeof(char))) == NULL)
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-
-    // the float is saved as a char* since it can contain an exponent
-    strcpy((token->attribute), vector->value);
+    // the attribute stays a view of the number as written, the code generator only uses the parsed value
+    SetAttributeView(token, start, length);
+    if (token->token_type == DOUBLE_64)
+        token->value.floating = ParseDouble(token->attribute, length);
+    else
+        token->value.integer = ParseInteger(token->attribute, length);
 
     // Check the leading zeroes, // TODO: check
-    if (token->token_type == INTEGER_32 && strlen(token->attribute) > 1 && token->attribute[0] == '0' && token->attribute[1] == '0')
+    if (token->token_type == INTEGER_32 && token->length > 1 && token->attribute[0] == '0' && token->attribute[1] == '0')
     {
-        fprintf(stderr, "Line %d: Invalid token %s\n", *line_number, token->attribute);
-        DestroyToken(token);
+        AbortChunk();
+        fprintf(stderr, "Line %d: Invalid token %.*s\n", *line_number, token->length, token->attribute);
         exit(ERROR_LEXICAL);
     }
-
-    DestroyVector(vector);
 }
 
-bool ConsumeExponent(Vector *vector, Token *token, bool has_floating_point)
+bool ConsumeExponent(Token *token, bool has_floating_point)
 {
-    // at the start getchar() will return 'e'/'E' since we used ungetc()
-    int c = getchar();
+    // at the start GET_CHAR() will return 'e'/'E' since we used UNGET_CHAR()
+    int c = GET_CHAR();
 
     /*reminder: valid float construction:
     3.14, or 3e-2 or 3e+2 or 3e2 or 3.14e-2 or 3.14e+2 or 3.14e2
@@ -187,26 +518,24 @@ bool ConsumeExponent(Vector *vector, Token *token, bool has_floating_point)
 
     // if the next character isn't a sign or a digit the number stays as it is
     int next;
-    if ((next = NextChar()) == '+' || next == '-' || isdigit(next))
+    if ((next = PEEK_CHAR(0)) == '+' || next == '-' || IS_DIGIT(next))
     {
-        AppendChar(vector, c);
-        AppendChar(vector, next);
-        getchar(); // move the stream forward
+        GET_CHAR(); // move the stream forward
     }
 
     else
-    { // return 'e'/'E' to the stream, the token stays a number
+    { // the caller returns 'e'/'E' to the stream, the token stays a number
         if (!has_floating_point)
             token->token_type = INTEGER_32;
         return false;
     }
 
-    // here we found a digit/sign and appended it, so the only thing that remains is to append remaining digits
-    while (isdigit(c = getchar()))
-        AppendChar(vector, c);
+    // here we found a digit/sign, so the only thing that remains is to skip the remaining digits
+    while (IS_DIGIT(c = GET_CHAR()))
+        continue;
 
     // unget the last character after the numbers so that the scanner can process it
-    ungetc(c, stdin);
+    UNGET_CHAR(c);
     return true;
 }
 
@@ -214,65 +543,58 @@ void ConsumeIdentifier(Token *token, int *line_number)
 {
     // needed variables
     int c;
-    Vector *vector = InitVector();
+    size_t start = source.position;
 
     // lone '_' identifier case
-    if ((c = getchar()) == '_' && !isalnum(NextChar()) && NextChar() != '_')
+    if ((c = GET_CHAR()) == '_' && !IS_IDENTIFIER_CHAR(PEEK_CHAR(0)))
     {
         token->token_type = UNDERSCORE_TOKEN;
-        token->attribute = strdup("_");
+        SetAttributeView(token, start, 1);
         token->line_number = *line_number;
-        DestroyVector(vector);
         return;
     }
 
-    // append the characters until we reach the end of the identifier
-    AppendChar(vector, c);
-    while (isalnum(c = getchar()) || c == '_')
-    {
-        AppendChar(vector, c);
-    }
+    // skip the characters until we reach the end of the identifier
+    while (IS_IDENTIFIER_CHAR(c = GET_CHAR()))
+        continue;
+
+    // the identifier ends right before c (EOF doesn't move the cursor)
+    SetAttributeView(token, start, source.position - start - (c != EOF));
 
     if (c == '\n')
         ++(*line_number);
     else
-        ungetc(c, stdin);
-
-    // terminate the vector
-    AppendChar(vector, '\0');
-
-    // copy the vector's value to the token's attribute (the identifier name)
-    if ((token->attribute = malloc(vector->length * sizeof(char))) == NULL)
-    {
-        DestroyVector(vector);
-        DestroyToken(token);
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-    }
-
-    strcpy(token->attribute, vector->value);
-    DestroyVector(vector);
+        UNGET_CHAR(c);
 
     // check if the token isn't an invalid one with a prefix
     if (token->attribute[0] == '?')
     {
-        if (!IsValidPrefix(token->attribute))
+        if (!IsValidPrefix(token->attribute, token->length))
         {
-            fprintf(stderr, RED "Error in lexical analysis: Line %d: Invalid token %s\n" RESET, *line_number, token->attribute);
-            DestroyToken(token);
+            AbortChunk();
+            fprintf(stderr, RED "Error in lexical analysis: Line %d: Invalid token %.*s\n" RESET, *line_number, token->length, token->attribute);
             exit(ERROR_LEXICAL);
         }
 
         token->token_type = KEYWORD;
-        token->keyword_type = IsKeyword(token->attribute);
+        token->keyword_type = IsKeyword(token->attribute, token->length);
 
         return;
     }
 
     // check if the identifier isn't actually a keyword
     KEYWORD_TYPE keyword_type;
-    if ((keyword_type = IsKeyword(token->attribute)) == NONE)
+    if ((keyword_type = IsKeyword(token->attribute, token->length)) == NONE)
     {
+        // every occurrence of the name gets the same id and shares the interned copy of it
         token->token_type = IDENTIFIER_TOKEN;
+
+        // the interner isn't thread safe, identifiers of a chunk are interned by the main thread in the order of the source
+        if (chunk_abort == NULL)
+        {
+            token->symbol_id = InternString(token->attribute, token->length);
+            token->attribute = InternedName(token->symbol_id);
+        }
     }
 
     else
@@ -287,99 +609,95 @@ void ConsumeIdentifier(Token *token, int *line_number)
 void ConsumeLiteral(Token *token, int *line_number)
 {
     int c;
-    Vector *vector = InitVector();
+    size_t start = source.position;
+
+    // a literal without escape sequences can stay in the source, so look for the end first
+    source.position = FindLiteralStop(source.data, source.position, source.length);
+    c = GET_CHAR();
 
-    // loop until we encounter another " character
-    while ((c = getchar()) != '"' && c != '\n' && c != EOF)
+    if (c == '"')
     {
-        if (c != '\\')
-            AppendChar(vector, c);
-        else
-        { // possible escape sequence
-            switch (c = getchar())
-            {
-            // all possible \x characters
-            case '"':
-                AppendChar(vector, '\"');
-                break;
+        SetAttributeView(token, start, source.position - 1 - start);
+        return;
+    }
 
-            case 'n':
-                AppendChar(vector, '\n');
-                break;
+    // the literal has to be built with the escape sequences replaced, so go back to its beginning
+    source.position = start;
+    scratch.length = 0;
 
-            case 'r':
-                AppendChar(vector, '\r');
-                break;
+    // loop until we encounter another " character, the plain characters between escape sequences are copied in bulk
+    while (true)
+    {
+        size_t stop = FindLiteralStop(source.data, source.position, source.length);
+        AppendChars(&scratch, source.data + source.position, stop - source.position);
+        source.position = stop;
 
-            case 't':
-                AppendChar(vector, '\t');
-                break;
+        if ((c = GET_CHAR()) == '"' || c == '\n' || c == EOF)
+            break;
 
-            case 'x':
-                ConsumeHexadecimalEscapeSequence(vector, line_number);
-                break;
+        // c is a '\\', possible escape sequence
+        switch (c = GET_CHAR())
+        {
+        // all possible \x characters
+        case '"':
+            AppendChar(&scratch, '\"');
+            break;
 
-            case '\\':
-                AppendChar(vector, c);
-                break;
+        case 'n':
+            AppendChar(&scratch, '\n');
+            break;
 
-            // invalid escape sequence, throw a lexical error
-            default:
-                DestroyToken(token);
-                DestroyVector(vector);
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid escape sequence '/%c' in a literal", *line_number, c);
-            }
+        case 'r':
+            AppendChar(&scratch, '\r');
+            break;
+
+        case 't':
+            AppendChar(&scratch, '\t');
+            break;
+
+        case 'x':
+            ConsumeHexadecimalEscapeSequence(line_number);
+            break;
+
+        case '\\':
+            AppendChar(&scratch, c);
+            break;
+
+        // invalid escape sequence, throw a lexical error
+        default:
+            LEXICAL_ERROR("Line %d: Invalid escape sequence '/%c' in a literal", *line_number, c);
         }
     }
 
-    // terminate the string
-    AppendChar(vector, '\0');
-
     // either a valid end of a string, or throw an error in case of newline/end of file
     switch (c)
     {
     case '"': // valid string ending, copy the string to the token's attribute
-        if ((token->attribute = malloc(vector->length * sizeof(char))) == NULL)
-        {
-            DestroyToken(token);
-            DestroyVector(vector);
-            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-        }
-
-        strcpy(token->attribute, vector->value);
-        DestroyVector(vector);
+        SetAttributeFromScratch(token);
         break;
 
     case '\n':
     case EOF:
-        DestroyToken(token);
-        DestroyVector(vector);
-        ErrorExit(ERROR_LEXICAL, "Line %d: String missing a second \"", *line_number);
+        LEXICAL_ERROR("Line %d: String missing a second \"", *line_number);
     }
 }
 
 void ConsumeMultiLineLiteral(Token *token, int *line_number)
 {
     int c;
-    Vector *vector = InitVector();
+    scratch.length = 0;
 
     // At the start, we are after the initial '\\' duo
     while (true)
     {
-        c = getchar();
+        // The whole rest of the line belongs to the literal
+        size_t line_end = FindLineEnd(source.data, source.position, source.length);
+        AppendChars(&scratch, source.data + source.position, line_end - source.position);
+        source.position = line_end;
 
-        // Non-escape sequence or newline characters
-        if (c != '\n' && c != EOF)
+        if ((c = GET_CHAR()) == EOF)
         {
-            AppendChar(vector, c);
-            continue;
-        }
-
-        else if (c == EOF)
-        {
-            DestroyToken(token);
-            DestroyVector(vector);
-            ErrorExit(ERROR_LEXICAL, "Line %d: Unexpected end of file", *line_number);
+            LEXICAL_ERROR("Line %d: Unexpected end of file", *line_number);
         }
 
         else
@@ -387,7 +705,7 @@ void ConsumeMultiLineLiteral(Token *token, int *line_number)
             ++(*line_number);
             if (DoesMultiLineLiteralContinue(line_number))
             {
-                AppendChar(vector, '\n');
+                AppendChar(&scratch, '\n');
                 continue;
             }
             else
@@ -395,24 +713,20 @@ void ConsumeMultiLineLiteral(Token *token, int *line_number)
         }
     }
 
-    // Terminate the string
-    AppendChar(vector, '\0');
-
-    // Copy the string to the token's attribute
-    token->attribute = strdup(vector->value);
-    DestroyVector(vector);
+    // Copy the string to the token's attribute, the lines are joined so it can't be a view into the source
+    SetAttributeFromScratch(token);
 }
 
 bool DoesMultiLineLiteralContinue(int *line_number)
 {
     int c;
-    while ((c = getchar()) != EOF)
+    while ((c = GET_CHAR()) != EOF)
     {
         if (c != '\\' && c != '\n')
         {
-            if (!isspace(c))
+            if (!IS_SPACE(c))
             {
-                ungetc(c, stdin);
+                UNGET_CHAR(c);
                 return false;
             }
         }
@@ -425,43 +739,42 @@ bool DoesMultiLineLiteralContinue(int *line_number)
 
         else
         {
-            if ((c = NextChar()) == '\\')
+            if (PEEK_CHAR(0) == '\\')
             {
-                getchar();
+                GET_CHAR();
                 return true;
             }
 
+            // a lone backslash, leave it in the source so that it's reported as an invalid token
             else
             {
-                ungetc(c, stdin);
+                UNGET_CHAR(c);
                 return false;
             }
         }
     }
 
-    ungetc(c, stdin);
+    UNGET_CHAR(c);
     return false;
 }
 
-void ConsumeHexadecimalEscapeSequence(Vector *vector, int *line_number)
+void ConsumeHexadecimalEscapeSequence(int *line_number)
 {
     int c;
     char digit_1, digit_2;
 
     // Do this twice :))
-    if (!isdigit(c = getchar()))
+    if (!IS_DIGIT(c = GET_CHAR()))
     {
-        DestroyVector(vector);
-        ErrorExit(ERROR_LEXICAL, "Line %d: Invalid hexadecimal escape sequence '\\x%c'", *line_number, c);
+        LEXICAL_ERROR("Line %d: Invalid hexadecimal escape sequence '\\x%c'", *line_number, c);
     }
 
     else
         digit_1 = c;
 
-    if (!isdigit(c = getchar()))
+    if (!IS_DIGIT(c = GET_CHAR()))
     {
-        DestroyVector(vector);
-        ErrorExit(ERROR_LEXICAL, "Line %d: Invalid hexadecimal escape sequence '\\x%c'", *line_number, c);
+        LEXICAL_ERROR("Line %d: Invalid hexadecimal escape sequence '\\x%c'", *line_number, c);
     }
 
     else
@@ -471,17 +784,16 @@ void ConsumeHexadecimalEscapeSequence(Vector *vector, int *line_number)
     char hex[3] = {digit_1, digit_2, '\0'};
     int value = strtol(hex, NULL, 16);
 
-    // Append the character to the vector
-    AppendChar(vector, value);
+    // Append the character to the literal
+    AppendChar(&scratch, value);
 }
 
 int ConsumeComment(int *line_number)
 {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF)
-    {
-        continue;
-    }
+    // jump straight to the end of the line
+    source.position = FindLineEnd(source.data, source.position, source.length);
+
+    int c = GET_CHAR();
 
     if (c == '\n')
         ++(*line_number);
@@ -496,110 +808,107 @@ void ConsumeImportToken(Token *token, int *line_number)
 
     for (int i = 0; i < 7; i++)
     {
-        if ((c = getchar()) != import[i])
+        if ((c = GET_CHAR()) != import[i])
         {
-            DestroyToken(token);
-            ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token '@'", *line_number);
+            LEXICAL_ERROR("Line %d: Invalid token '@'", *line_number);
         }
     }
 
     // token is valid
     token->token_type = IMPORT_TOKEN;
-    token->attribute = strdup("@import");
+    SetAttributeView(token, source.position - 7, 7);
 }
 
 int ConsumeWhitespace(int *line_number)
 {
-    int c;
-    while (isspace(c = getchar()) && c != EOF)
-    {
-        if (c == '\n')
-            ++(*line_number);
-        continue;
-    }
-
-    return c;
+    source.position = SkipWhitespace(source.data, source.position, source.length, line_number);
+    return GET_CHAR();
 }
 
 void ConsumeU8Token(Token *token, int *line_number)
 {
-    // expected token structure to compare to and a storage array to store the actual token
+    // expected token structure to compare to
     char u8_token[] = "[]u8";
     char nullable_u8_token[] = "?[]u8";
-    char actual_token[6]; // max size is 6 because ? + u8[] + '\0'
 
-    // iterator and a variable to store all the incoming characters
+    // iterator and a variable to store all the incoming characters, the token itself stays in the source
     int i, c;
+    size_t start = source.position;
 
-    int length = NextChar() == '?' ? 5 : 4;
+    int length = PEEK_CHAR(0) == '?' ? 5 : 4;
     for (i = 0; i < length; i++)
     {
-        c = getchar();
+        c = GET_CHAR();
 
         if ((c != u8_token[i] && i != 5) && (c != nullable_u8_token[i]))
         {
-            DestroyToken(token);
-            actual_token[i] = '\0';
-            ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token %s%c", *line_number, actual_token, c);
+            LEXICAL_ERROR("Line %d: Invalid token %.*s%c", *line_number, i, source.data + start, c);
         }
-
-        else
-            actual_token[i] = c;
-    }
-
-    actual_token[i] = '\0';
-
-    // copy the u8[] string to the token
-    if ((token->attribute = malloc((length + 1) * sizeof(char))) == NULL)
-    {
-        DestroyToken(token);
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
     }
 
-    strcpy(token->attribute, actual_token);
+    // the u8[] string is the view of the consumed characters
+    SetAttributeView(token, start, length);
 
     token->line_number = *line_number;
     token->token_type = KEYWORD;
     token->keyword_type = U8;
 }
 
-KEYWORD_TYPE IsKeyword(char *attribute)
-{
-    // create a array of keywords(sice it's constant)
-    const char keyword_strings[][KEYWORD_COUNT] = {
-        "const",
-        "else",
-        "fn",
-        "if",
-        "i32",
-        "f64",
-        "null",
-        "pub",
-        "return",
-        "u8",
-        "var",
-        "void",
-        "while"};
-
-    if (attribute[0] == '?')
-    {
-        return IsKeyword(attribute + 1);
-    }
+// Slots of the keyword table, a perfect hash of the 13 keywords (no two of them collide, see KEYWORD_HASH)
+#define KEYWORD_TABLE_SIZE 16
 
-    for (int i = 0; i < KEYWORD_COUNT; i++)
+// Keyword lengths are 2 to 6, anything outside of this range can't be a keyword
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 6
+
+// Hash over the first two characters and the length, the multipliers were picked by trying them until every keyword got its own slot
+#define KEYWORD_HASH(string, length) ((((unsigned char)(string)[0]) * 13u + ((unsigned char)(string)[1]) * 6u + (unsigned)(length)) & (KEYWORD_TABLE_SIZE - 1))
+
+typedef struct
+{
+    const char *name;
+    int length;
+    KEYWORD_TYPE type;
+} KeywordEntry;
+
+// Compile time table indexed by KEYWORD_HASH, the empty slots have a NULL name
+static const KeywordEntry keyword_table[KEYWORD_TABLE_SIZE] = {
+    [0] = {"while", 5, WHILE},
+    [1] = {"pub", 3, PUB},
+    [3] = {"u8", 2, U8},
+    [4] = {"fn", 2, FN},
+    [5] = {"f64", 3, F64},
+    [6] = {"const", 5, CONST},
+    [7] = {"var", 3, VAR},
+    [8] = {"null", 4, NULL_TYPE},
+    [10] = {"i32", 3, I32},
+    [11] = {"if", 2, IF},
+    [12] = {"void", 4, VOID},
+    [13] = {"else", 4, ELSE},
+    [14] = {"return", 6, RETURN},
+};
+
+KEYWORD_TYPE IsKeyword(const char *attribute, int length)
+{
+    if (length > 0 && attribute[0] == '?')
     {
-        if (!strcmp(attribute, keyword_strings[i]))
-        {
-            return i;
-        }
+        return IsKeyword(attribute + 1, length - 1);
     }
 
+    if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH)
+        return NONE;
+
+    // one hash and one memcmp, the length check also rules out the empty slots
+    const KeywordEntry *entry = &keyword_table[KEYWORD_HASH(attribute, length)];
+    if (entry->length == length && !memcmp(attribute, entry->name, length))
+        return entry->type;
+
     return NONE;
 }
 
-bool IsValidPrefix(char *identifier)
+bool IsValidPrefix(const char *identifier, int length)
 {
-    return IsKeyword(identifier + 1) == NONE ? false : true;
+    return IsKeyword(identifier + 1, length - 1) == NONE ? false : true;
 }
 
 Token *LoadTokenFromStream(int *line_number)
@@ -617,271 +926,224 @@ Token *LoadTokenFromStream(int *line_number)
         return token;
     }
 
+    // c is always the (already consumed) first character of the token here
     while (true)
     {
-        switch (c = (isspace(c)) ? getchar() : c)
-        {
-        /*operator tokens*/
-        case '=': // valid tokens are = and also ==
-            if ((c = NextChar()) == '=')
-            {
-                getchar();
-                token->attribute = strdup("==");
-                token->token_type = EQUAL_OPERATOR;
-            }
-
-            else
-            {
-                token->attribute = strdup("=");
-                token->token_type = ASSIGNMENT;
-            }
+        token_start = source.position - (c != EOF);
+        token_start_line = *line_number;
 
+        if (c == EOF)
+        {
+            token->token_type = EOF_TOKEN;
             token->line_number = *line_number;
             return token;
+        }
 
-        case '+':
-            token->attribute = strdup("+");
-            token->token_type = ADDITION_OPERATOR;
+        CHAR_CLASS char_class = CHAR_CLASS_OF(c);
+        switch (start_states[char_class])
+        {
+        /*one character tokens, the class determines the token type*/
+        case STATE_SINGLE_CHAR:
+            SetAttributeView(token, source.position - 1, 1);
+            token->token_type = single_char_tokens[char_class];
             token->line_number = *line_number;
             return token;
 
-        case '-':
-            token->attribute = strdup("-");
-            token->token_type = SUBSTRACTION_OPERATOR;
-            token->line_number = *line_number;
-            return token;
+        /*operator tokens which can have a second '=' character (=/==, </<=, >/>=, !=)*/
+        case STATE_OPERATOR:
+        {
+            bool has_equals = (next = PEEK_CHAR(0)) == '=';
+
+            //! by itself isn't a valid token, however != is
+            if (char_class == CLASS_EXCLAMATION && !has_equals)
+            {
+                LEXICAL_ERROR("Line %d: Invalid token !%c", *line_number, next);
+            }
+
+            if (has_equals)
+                GET_CHAR(); // consume the = character
 
-        case '*':
-            token->attribute = strdup("*");
-            token->token_type = MULTIPLICATION_OPERATOR;
+            SetAttributeView(token, source.position - 1 - has_equals, 1 + has_equals);
+            token->token_type = operator_tokens[char_class][has_equals];
             token->line_number = *line_number;
             return token;
+        }
 
-        case '/': // can also signal the start of a comment
-            if ((next = NextChar()) != '/')
+        case STATE_SLASH: // can also signal the start of a comment
+            if ((next = PEEK_CHAR(0)) != '/')
             {
-                token->attribute = strdup("/");
+                SetAttributeView(token, source.position - 1, 1);
                 token->token_type = DIVISION_OPERATOR;
                 token->line_number = *line_number;
                 return token;
             }
 
             // indicates the start of a comment --> consume the second '/' character and skip to the end of the line/file
-            getchar();
-            c = ConsumeComment(line_number);
+            GET_CHAR();
 
-            // run the switch again with the first character after the comment ends
+            // run the DFA again with the first character after the comment and the whitespace following it
+            if ((c = ConsumeComment(line_number)) == '\n')
+                c = ConsumeWhitespace(line_number);
             continue;
 
-        case '!': //! by itself isn't a valid token, however != is
-            if ((next = NextChar()) != '=')
-            {
-                DestroyToken(token);
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token !%c", *line_number, next);
-            }
-
-            else
-            {
-                token->attribute = strdup("!=");
-                getchar();
-                token->line_number = *line_number;
-                token->token_type = NOT_EQUAL_OPERATOR;
-            }
-
-            return token;
-
-        case '<': //< is a valid token, but so is <=
-            if ((next = NextChar()) != '=')
-            {
-                token->attribute = strdup("<");
-                token->token_type = LESS_THAN_OPERATOR;
-            }
-
-            else
-            {
-                token->attribute = strdup("<=");
-                getchar(); // consume the = character
-                token->token_type = LESSER_EQUAL_OPERATOR;
-            }
-
-            token->line_number = *line_number;
-            return token;
-
-        case '>': // analogous to <
-            if ((next = NextChar()) != '=')
-            {
-                token->attribute = strdup(">");
-                token->token_type = LARGER_THAN_OPERATOR;
-            }
-
-            else
-            {
-                token->attribute = strdup(">=");
-                getchar();
-                token->token_type = LARGER_EQUAL_OPERATOR;
-            }
-
-            token->line_number = *line_number;
-            return token;
-
-        /*bracket tokens and array symbol*/
-        case '(':
-            token->attribute = strdup("(");
-            token->token_type = L_ROUND_BRACKET;
-            token->line_number = *line_number;
-            return token;
-
-        case ')':
-            token->attribute = strdup(")");
-            token->token_type = R_ROUND_BRACKET;
-            token->line_number = *line_number;
-            return token;
-
-        case '{':
-            token->attribute = strdup("{");
-            token->token_type = L_CURLY_BRACKET;
-            token->line_number = *line_number;
-            return token;
-
-        case '}':
-            token->attribute = strdup("}");
-            token->token_type = R_CURLY_BRACKET;
-            token->line_number = *line_number;
-            return token;
-
-        case '[': // A bit of a special case, []u8 is a keyword that can't be mistaken for a identifier but u8 can but u8 by itself is a invalid token
-            ungetc(c, stdin);
-            ConsumeU8Token(token, line_number);
-            return token;
+        case STATE_WHITESPACE:
+            UNGET_CHAR(c);
+            c = ConsumeWhitespace(line_number);
+            continue;
 
-        case '|':
-            token->attribute = strdup("|");
-            token->token_type = VERTICAL_BAR_TOKEN;
+        /*beginning of a identifier (or a lone '_')*/
+        case STATE_IDENTIFIER:
+            // return the character back, since the consume functions parse the whole token
+            UNGET_CHAR(c);
+            ConsumeIdentifier(token, line_number);
             token->line_number = *line_number;
             return token;
 
-        /*special symbols*/
-        case '?':
-            next = NextChar();
-            ungetc(c, stdin);
+        /*a type with the '?' prefix*/
+        case STATE_PREFIX:
+            next = PEEK_CHAR(0);
+            UNGET_CHAR(c);
 
-            if (isalnum(next))
+            if (IS_ALNUM(next))
                 ConsumeIdentifier(token, line_number);
             else if (next == '[')
                 ConsumeU8Token(token, line_number);
             else
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token '?'", *line_number);
+                LEXICAL_ERROR("Line %d: Invalid token '?'", *line_number);
 
             return token;
 
-        case EOF:
-            token->token_type = EOF_TOKEN;
+        case STATE_NUMBER:
+            UNGET_CHAR(c);
+            ConsumeNumber(token, line_number);
             token->line_number = *line_number;
             return token;
 
-        case ';':
-            token->attribute = strdup(";");
-            token->token_type = SEMICOLON;
-            token->line_number = *line_number;
-            return token;
+        /*multiple 0's are an invalid token*/
+        case STATE_ZERO:
+            if (IS_DIGIT(next = PEEK_CHAR(0)))
+                LEXICAL_ERROR("Line %d: Invalid token '0%c'", *line_number, next);
 
-        case '_':
-            ungetc(c, stdin);
-            ConsumeIdentifier(token, line_number);
-            token->line_number = *line_number;
-            return token;
+            UNGET_CHAR(c);
+            ConsumeNumber(token, line_number);
 
-        case '@':
-            ungetc(c, stdin);
-            ConsumeImportToken(token, line_number);
             token->line_number = *line_number;
             return token;
 
-        case ':':
-            token->attribute = strdup(":");
-            token->token_type = COLON_TOKEN;
+        /*Beginning of a string*/
+        case STATE_LITERAL:
+            token->token_type = LITERAL_TOKEN;
+            ConsumeLiteral(token, line_number);
             token->line_number = *line_number;
             return token;
 
-        case '.':
-            token->attribute = strdup(".");
-            token->token_type = DOT_TOKEN;
+        // Signals the start of a multiline string
+        case STATE_MULTILINE_LITERAL:
+            if ((next = PEEK_CHAR(0)) != '\\')
+            {
+                LEXICAL_ERROR("Line %d: Invalid token '\\%c'", *line_number, next);
+            }
+
+            GET_CHAR();
+            token->token_type = LITERAL_TOKEN;
             token->line_number = *line_number;
+            ConsumeMultiLineLiteral(token, line_number);
             return token;
 
-        case ',':
-            token->attribute = strdup(",");
-            token->token_type = COMMA_TOKEN;
-            token->line_number = *line_number;
+        // A bit of a special case, []u8 is a keyword that can't be mistaken for a identifier but u8 can but u8 by itself is a invalid token
+        case STATE_U8:
+            UNGET_CHAR(c);
+            ConsumeU8Token(token, line_number);
             return token;
 
-        /*Beginning of a string*/
-        case '"':
-            token->token_type = LITERAL_TOKEN;
-            ConsumeLiteral(token, line_number);
+        case STATE_IMPORT:
+            UNGET_CHAR(c);
+            ConsumeImportToken(token, line_number);
             token->line_number = *line_number;
             return token;
 
-        /*multiple 0's are an invalid token*/
-        case '0':
-            if (isdigit(next = NextChar()))
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token '0%c'", *line_number, next);
+        case STATE_INVALID:
+        default:
+            LEXICAL_ERROR("Line %d: Invalid token %c", *line_number, c);
+        }
+    }
+}
 
-            ungetc(c, stdin);
-            ConsumeNumber(token, line_number);
+void ScanSourceChunk(SourceChunk *chunk, const char *data, size_t length)
+{
+    // the chunk is scanned as a part of the whole source, so that a token crossing its end can still be finished
+    source = (SourceBuffer){data, length, chunk->start, false};
+    chunk->tokens = InitTokenStream();
+    chunk->tokens->identifier_text = true;
+    chunk->scan_lines = NULL;
+    chunk->failed = false;
+
+    // lines are counted from the start of the chunk, the main thread adds the lines before it
+    int line_number = 1;
+    int capacity = 0;
+
+    jmp_buf abort_point;
+    chunk_abort = &abort_point;
+    if (setjmp(abort_point) == 0)
+    {
+        while (true)
+        {
+            Token *token = LoadTokenFromStream(&line_number);
 
-            token->line_number = *line_number;
-            return token;
+            // a token starting at the end of the chunk belongs to the next one
+            if (token->token_type != EOF_TOKEN && token_start >= chunk->end)
+                break;
 
-        // Signals the start of a multiline string
-        case '\\':
-            if ((next = NextChar()) == '\\')
+            if (chunk->tokens->length + 1 > capacity)
             {
-                getchar();
-                token->token_type = LITERAL_TOKEN;
-                token->line_number = *line_number;
-                ConsumeMultiLineLiteral(token, line_number);
-
-                return token;
+                capacity = ALLOC_CHUNK(capacity);
+                if ((chunk->scan_lines = realloc(chunk->scan_lines, capacity * sizeof(int))) == NULL)
+                    ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
             }
 
-            else
-            {
-                DestroyToken(token);
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token '\\%c'", *line_number, next);
-            }
+            bool is_eof = token->token_type == EOF_TOKEN;
+            chunk->scan_lines[chunk->tokens->length] = line_number;
+            StreamAppendToken(chunk->tokens, token);
+            RecycleTokens();
 
-            break;
+            if (is_eof)
+                break;
+        }
+    }
 
-        /*call GetSymbolType to determine next token*/
-        default:
-            // return the character back, since the consume functions parse the whole token
-            ungetc(c, stdin);
+    // a lexical error, unless the faulty token is already a part of the next chunk the serial scanner takes over from it
+    else if (token_start < chunk->end)
+    {
+        chunk->failed = true;
+        chunk->error_position = token_start;
+        chunk->error_line = token_start_line;
+    }
 
-            // call a sub-FSM function depending on the char type
-            switch (GetCharType(c))
-            {
-            /*beginning of a identifier*/
-            case CHARACTER:
-                ConsumeIdentifier(token, line_number);
-                token->line_number = *line_number;
-                return token;
+    chunk_abort = NULL;
 
-            case NUMBER:
-                ConsumeNumber(token, line_number);
-                token->line_number = *line_number;
-                return token;
+    // the attributes go with the chunk, everything else the thread used is freed
+    chunk->attributes = attribute_arena;
+    attribute_arena = (Arena){NULL};
+    ArenaRelease(&token_arena);
+    free(scratch.value);
+    scratch = (Vector){0, 0, NULL};
+    source = (SourceBuffer){NULL, 0, 0, false};
+}
 
-            case WHITESPACE:
-                c = ConsumeWhitespace(line_number);
-                continue;
+void AdoptChunkAttributes(SourceChunk *chunk)
+{
+    ArenaAdopt(&attribute_arena, &chunk->attributes);
+}
 
-            default:
-                DestroyToken(token);
-                ErrorExit(ERROR_LEXICAL, "Line %d: Invalid token %c", *line_number, c);
-            }
-        }
-    }
+const char *SourceData(size_t *length)
+{
+    *length = source.length;
+    return source.data;
+}
+
+void SeekSource(size_t position)
+{
+    source.position = position;
 }
 
 void PrintToken(Token *token)
@@ -889,15 +1151,15 @@ void PrintToken(Token *token)
     switch (token->token_type)
     {
     case IDENTIFIER_TOKEN:
-        fprintf(stderr, "Type: Identifier token, attribute: %s", token->attribute);
+        fprintf(stderr, "Type: Identifier token, attribute: %.*s", token->length, token->attribute);
         break;
 
     case INTEGER_32:
-        fprintf(stderr, "Type: Int32 token, attribute: %s", token->attribute);
+        fprintf(stderr, "Type: Int32 token, attribute: %.*s", token->length, token->attribute);
         break;
 
     case DOUBLE_64:
-        fprintf(stderr, "Type: F64 token, attribute: %s", token->attribute);
+        fprintf(stderr, "Type: F64 token, attribute: %.*s", token->length, token->attribute);
         break;
 
     case ASSIGNMENT:
@@ -969,7 +1231,7 @@ void PrintToken(Token *token)
         break;
 
     case KEYWORD:
-        fprintf(stderr, "Type: Keyword. Keyword type: %s", token->attribute);
+        fprintf(stderr, "Type: Keyword. Keyword type: %.*s", token->length, token->attribute);
         break;
 
     case UNDERSCORE_TOKEN:
@@ -997,7 +1259,7 @@ void PrintToken(Token *token)
         break;
 
     case LITERAL_TOKEN:
-        fprintf(stderr, "Type: string literal, value: %s", token->attribute);
+        fprintf(stderr, "Type: string literal, value: %.*s", token->length, token->attribute);
         break;
 
     default:
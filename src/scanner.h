@@ -12,6 +12,17 @@
 
 #define KEYWORD_COUNT 13
 
+/**
+ * @brief Loads the whole source program so that the scanner can work on a buffer instead of stdin
+ *
+ * @param path File to compile, if NULL the program is read from stdin
+ * @note Regular files are mapped with mmap(), other inputs are read into a malloc'd buffer
+ */
+void LoadSource(const char *path);
+
+// Releases the source buffer loaded by LoadSource()
+void DestroySource();
+
 /**
  * @brief Gets next token from the input stream (skipping whitespace)
  *
@@ -20,25 +31,29 @@
  */
 Token *LoadTokenFromStream(int *line_number);
 
-// Token constructor
+// Token constructor, the token is allocated in the token arena and lives until ReleaseTokens()
 Token *InitToken();
 
-// Retuns a copy of the token passed as a parameter to avoid double freeing
+// Retuns a copy of the token passed as a parameter (sharing the attribute, which is never modified)
 Token *CopyToken(Token *token);
 
-// Token destructor
-void DestroyToken(Token *token);
+// Frees every token and attribute created so far at once (the interned identifiers too), there is no way to free a single token
+void ReleaseTokens();
 
-// Returns the next character from stdin without moving forward (it returns the character back)
-char NextChar();
+// Invalidates every Token created so far (but not their attributes) so that the memory can be reused for new ones
+void RecycleTokens();
 
-/**
- * @brief Gets the next character's type
- *
- * @param c : a character that isn't unique, e.g it belongs to a range of characters which can't be handled by a switch case (e.g [A-Z], etc.)
- * @return CHAR_TYPE Whitespace/Character/Number or Other (probably invalid token and error)
- */
-CHAR_TYPE GetCharType(char c);
+// Gives the token a copy of the NUL-terminated attribute (or no attribute for NULL), the copy lives until ReleaseTokens()
+void SetTokenAttribute(Token *token, const char *attribute);
+
+// Attributes aren't NUL-terminated, so they can't be passed to strcmp() directly. Returns true if the attribute is exactly the given string
+bool AttributeEquals(Token *token, const char *string);
+
+// Returns a newly allocated, NUL-terminated copy of the token's attribute (e.g. for symbol names which outlive the token)
+char *AttributeToString(Token *token);
+
+// Returns the next character of the source without moving forward
+char NextChar();
 
 /**
  * @brief Handles a numeric literal token
@@ -51,12 +66,11 @@ void ConsumeNumber(Token *token, int *line_number);
 /**
  * @brief Helper function for ConsumeNumber, consumes the number's exponent
  *
- * @param vector Vector to add characters to
  * @param token To change the type if needed
  * @param has_floating_point a flag if the token is a valid DOUBLE_64 token even without the exponent
  * @return bool A flag to let ConsumeNumber know whether to end the loop or not
  */
-bool ConsumeExponent(Vector *vector, Token *token, bool has_floating_point);
+bool ConsumeExponent(Token *token, bool has_floating_point);
 
 /**
  * @brief Handles a string literal
@@ -76,12 +90,11 @@ void ConsumeLiteral(Token *token, int *line_number);
 bool DoesMultiLineLiteralContinue(int *line_number);
 
 /**
- * @brief Consumes and validates a escape sequence of the form \xHH in a literal
+ * @brief Consumes and validates a escape sequence of the form \xHH in a literal, appending the character to the literal being built
  *
- * @param vector Vector containing the overlapping literal
  * @param line_number Current line number
  */
-void ConsumeHexadecimalEscapeSequence(Vector *vector, int *line_number);
+void ConsumeHexadecimalEscapeSequence(int *line_number);
 
 /**
  * @brief Handles a multi-line string literal
@@ -119,15 +132,35 @@ int ConsumeWhitespace(int *line_number);
 void ConsumeU8Token(Token *token, int *line_number);
 
 // checks if a identifier with a prefix at the start is valid or not (so if it's a keyword)
-bool IsValidPrefix(char *identifier);
+bool IsValidPrefix(const char *identifier, int length);
 
 /**
  * @brief Checks if the token passed is a keyword
  *
  * @param attribute The given string
+ * @param length Length of the string, it doesn't have to be NUL-terminated
  * @return KEYWORD_TYPE NONE if not a keyword, otherwise the which one it is
  */
-KEYWORD_TYPE IsKeyword(char *attribute);
+KEYWORD_TYPE IsKeyword(const char *attribute, int length);
+
+/**
+ * @brief Scans one chunk of the source on the calling thread, used by the threads of the parallel scanner
+ *
+ * @param chunk Chunk with start and end set, the rest of it is filled in. Lexical errors are recorded in it instead of reported
+ * @param data The whole source, from SourceData() of the main thread
+ * @param length Length of the source
+ * @note Identifiers aren't interned, AdoptChunkAttributes() has to be called on the main thread to keep the attributes
+ */
+void ScanSourceChunk(SourceChunk *chunk, const char *data, size_t length);
+
+// Hands the attributes of a scanned chunk over to the main thread's scanner, so that they live until ReleaseTokens()
+void AdoptChunkAttributes(SourceChunk *chunk);
+
+// Returns the source loaded by LoadSource() and its length
+const char *SourceData(size_t *length);
+
+// Moves the scanner to the given position of the source, the next token is scanned from there
+void SeekSource(size_t position);
 
 // debug function
 void PrintToken(Token *token);
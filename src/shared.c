@@ -16,6 +16,9 @@ int strcmp_count = 0;
 int ord_count = 0;
 int substring_count = 0;
 
+int ifj_symbol_id = 0;
+int main_symbol_id = 0;
+
 const char token_types[TOKEN_COUNT][MAXLENGTH_TOKEN] = {
     "identifier",
     "_",
@@ -110,6 +113,6 @@ DATA_TYPE embedded_parameters[EMBEDDED_FUNCTION_COUNT][MAXPARAM_EMBEDDED_FUNCTIO
 
 int first_token_line = 1;
 
-TokenVector *stream = NULL;
+TokenStream *stream = NULL;
 
 int stream_index = 0;
\ No newline at end of file
@@ -17,6 +17,24 @@
 #define MAXLENGTH_EMBEDDED_FUNCTION 10
 #define MAXPARAM_EMBEDDED_FUNCTION 3
 
+// Indices of the embedded functions in the embedded_ tables below (in the order of embedded_names)
+typedef enum
+{
+    EMBEDDED_READSTR,
+    EMBEDDED_READI32,
+    EMBEDDED_READF64,
+    EMBEDDED_WRITE,
+    EMBEDDED_I2F,
+    EMBEDDED_F2I,
+    EMBEDDED_STRING,
+    EMBEDDED_LENGTH,
+    EMBEDDED_CONCAT,
+    EMBEDDED_SUBSTRING,
+    EMBEDDED_STRCMP,
+    EMBEDDED_ORD,
+    EMBEDDED_CHR
+} EMBEDDED_FUNCTION;
+
 // For token checking
 #define TOKEN_COUNT 30
 #define MAXLENGTH_TOKEN 11
@@ -45,8 +63,12 @@ extern DATA_TYPE embedded_return_types[EMBEDDED_FUNCTION_COUNT];
 // Contains the parameters for all embedded functions
 extern DATA_TYPE embedded_parameters[EMBEDDED_FUNCTION_COUNT][MAXPARAM_EMBEDDED_FUNCTION];
 
-// Contains the entire stream stored in a dynamic array of tokens
-extern TokenVector *stream;
+// Contains the entire token stream, see TokenStream in types.h
+extern TokenStream *stream;
+
+// Interned ids of the names the parser checks for, set by InitParser() so that they can be compared by id
+extern int ifj_symbol_id;
+extern int main_symbol_id;
 
 // Index to access the stream
 extern int stream_index;
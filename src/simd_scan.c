@@ -0,0 +1,252 @@
+/**
+ * @file simd_scan.c
+ * @brief Implementation of the vectorized scanner helpers (scalar, SSE2 and AVX2 variants)
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdbool.h>
+
+#include "simd_scan.h"
+
+#if !defined(IFJ24_NO_SIMD) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_SCAN_X86
+#include <immintrin.h>
+#endif
+
+/*---------- Scalar versions, also used for the tails shorter than a vector ----------*/
+
+// ' ', '\t', '\n', '\v', '\f', '\r'
+static inline bool IsWhitespace(unsigned char c)
+{
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+static size_t SkipWhitespaceScalar(const char *data, size_t position, size_t length, int *newlines)
+{
+    while (position < length && IsWhitespace(data[position]))
+    {
+        if (data[position] == '\n')
+            ++(*newlines);
+        position++;
+    }
+
+    return position;
+}
+
+static size_t FindLineEndScalar(const char *data, size_t position, size_t length)
+{
+    while (position < length && data[position] != '\n')
+        position++;
+
+    return position;
+}
+
+static size_t FindLiteralStopScalar(const char *data, size_t position, size_t length)
+{
+    while (position < length && data[position] != '"' && data[position] != '\\' && data[position] != '\n')
+        position++;
+
+    return position;
+}
+
+#ifdef SIMD_SCAN_X86
+
+/*---------- SSE2, 16 bytes at a time ----------*/
+
+// Bitmask of the whitespace bytes in the block, c - '\t' <= 4 (unsigned) covers '\t' to '\r'
+static inline unsigned WhitespaceMaskSSE2(__m128i block)
+{
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(control, space));
+}
+
+static size_t SkipWhitespaceSSE2(const char *data, size_t position, size_t length, int *newlines)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (position + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + position));
+        unsigned other = ~WhitespaceMaskSSE2(block) & 0xFFFFu;
+        unsigned lines = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+
+        if (other != 0)
+        {
+            // only count the newlines before the first non-whitespace character
+            unsigned first = __builtin_ctz(other);
+            *newlines += __builtin_popcount(lines & ((1u << first) - 1));
+            return position + first;
+        }
+
+        *newlines += __builtin_popcount(lines);
+        position += 16;
+    }
+
+    return SkipWhitespaceScalar(data, position, length, newlines);
+}
+
+static size_t FindLineEndSSE2(const char *data, size_t position, size_t length)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (position + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + position));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        if (mask != 0)
+            return position + __builtin_ctz(mask);
+
+        position += 16;
+    }
+
+    return FindLineEndScalar(data, position, length);
+}
+
+static size_t FindLiteralStopSSE2(const char *data, size_t position, size_t length)
+{
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), newline = _mm_set1_epi8('\n');
+
+    while (position + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + position));
+        __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                                     _mm_cmpeq_epi8(block, newline));
+        unsigned mask = (unsigned)_mm_movemask_epi8(stops);
+        if (mask != 0)
+            return position + __builtin_ctz(mask);
+
+        position += 16;
+    }
+
+    return FindLiteralStopScalar(data, position, length);
+}
+
+/*---------- AVX2, 32 bytes at a time (compiled for AVX2 only inside these functions) ----------*/
+
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+
+AVX2_FUNCTION static inline unsigned WhitespaceMaskAVX2(__m256i block)
+{
+    __m256i shifted = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    __m256i space = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' '));
+    return (unsigned)_mm256_movemask_epi8(_mm256_or_si256(control, space));
+}
+
+AVX2_FUNCTION static size_t SkipWhitespaceAVX2(const char *data, size_t position, size_t length, int *newlines)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    while (position + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + position));
+        unsigned other = ~WhitespaceMaskAVX2(block);
+        unsigned lines = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+
+        if (other != 0)
+        {
+            unsigned first = __builtin_ctz(other);
+            *newlines += __builtin_popcount(lines & ((1u << first) - 1));
+            return position + first;
+        }
+
+        *newlines += __builtin_popcount(lines);
+        position += 32;
+    }
+
+    // the rest is shorter than 32 bytes, SSE2 can still take a 16 byte step
+    return SkipWhitespaceSSE2(data, position, length, newlines);
+}
+
+AVX2_FUNCTION static size_t FindLineEndAVX2(const char *data, size_t position, size_t length)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    while (position + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + position));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        if (mask != 0)
+            return position + __builtin_ctz(mask);
+
+        position += 32;
+    }
+
+    return FindLineEndSSE2(data, position, length);
+}
+
+AVX2_FUNCTION static size_t FindLiteralStopAVX2(const char *data, size_t position, size_t length)
+{
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'), newline = _mm256_set1_epi8('\n');
+
+    while (position + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + position));
+        __m256i stops = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+                                        _mm256_cmpeq_epi8(block, newline));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(stops);
+        if (mask != 0)
+            return position + __builtin_ctz(mask);
+
+        position += 32;
+    }
+
+    return FindLiteralStopSSE2(data, position, length);
+}
+
+#endif
+
+/*---------- Runtime dispatch ----------*/
+
+static size_t (*skip_whitespace)(const char *, size_t, size_t, int *) = SkipWhitespaceScalar;
+static size_t (*find_line_end)(const char *, size_t, size_t) = FindLineEndScalar;
+static size_t (*find_literal_stop)(const char *, size_t, size_t) = FindLiteralStopScalar;
+
+const char *SelectScanFunctions(void)
+{
+#ifdef SIMD_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        skip_whitespace = SkipWhitespaceAVX2;
+        find_line_end = FindLineEndAVX2;
+        find_literal_stop = FindLiteralStopAVX2;
+        return "avx2";
+    }
+
+    // SSE2 is always there on x86-64
+    skip_whitespace = SkipWhitespaceSSE2;
+    find_line_end = FindLineEndSSE2;
+    find_literal_stop = FindLiteralStopSSE2;
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+size_t SkipWhitespace(const char *data, size_t position, size_t length, int *newlines)
+{
+    // most tokens are followed by at most a single space, which isn't worth loading a whole vector for
+    if (position + 1 < length && !IsWhitespace(data[position + 1]))
+    {
+        if (data[position] == '\n')
+            ++(*newlines);
+        return position + IsWhitespace(data[position]);
+    }
+
+    return skip_whitespace(data, position, length, newlines);
+}
+
+size_t FindLineEnd(const char *data, size_t position, size_t length)
+{
+    return find_line_end(data, position, length);
+}
+
+size_t FindLiteralStop(const char *data, size_t position, size_t length)
+{
+    return find_literal_stop(data, position, length);
+}
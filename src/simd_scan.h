@@ -0,0 +1,42 @@
+/**
+ * @file simd_scan.h
+ * @brief Vectorized helpers for the scanner's long runs of "uninteresting" characters
+ *
+ * Whitespace, comment bodies and string literal bodies are skipped 16 (SSE2) or 32 (AVX2) bytes at a time.
+ * The implementation is chosen at runtime by SelectScanFunctions(), every variant returns exactly the same
+ * results as the scalar one. Compiling with -DIFJ24_NO_SIMD (or for a non-x86 target) leaves only the scalar loops.
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <stddef.h>
+
+/**
+ * @brief Picks the fastest implementation the CPU supports, has to be called before the other functions
+ *
+ * @return const char* Name of the selected implementation ("avx2", "sse2" or "scalar")
+ */
+const char *SelectScanFunctions(void);
+
+/**
+ * @brief Skips whitespace (the characters isspace() accepts in the "C" locale)
+ *
+ * @param data The source buffer
+ * @param position Where to start
+ * @param length Length of the source buffer
+ * @param newlines Incremented by the number of skipped '\n' characters
+ * @return size_t Position of the first non-whitespace character, or length
+ */
+size_t SkipWhitespace(const char *data, size_t position, size_t length, int *newlines);
+
+// Returns the position of the next '\n' (the end of a comment) starting at position, or length if there is none
+size_t FindLineEnd(const char *data, size_t position, size_t length);
+
+// Returns the position of the next character which ends a run of plain literal characters ('"', '\\' or '\n'), or length
+size_t FindLiteralStop(const char *data, size_t position, size_t length);
+
+#endif
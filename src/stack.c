@@ -17,6 +17,7 @@
 // Implementations of operations on stacks for expression parsing and scope parsing
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "stack.h"
 #include "error.h"
@@ -25,9 +26,41 @@
 #include "shared.h"
 #include "vector.h"
 #include "expression_parser.h"
+#include "interner.h"
 
 /*********************** SYMTABLE STACK OPERATIONS ********************/
 
+#ifdef IFJ24_STATS
+// Counts a variable lookup, binding is the index + 1 of the binding found (0 if there's none)
+static void CountScopeLookup(SymtableStack *stack, int binding)
+{
+    symtable_stats.scope_lookups++;
+    symtable_stats.scope_depth_total += stack->size;
+    if (stack->size > symtable_stats.scope_depth_max)
+        symtable_stats.scope_depth_max = stack->size;
+
+    if (binding == 0)
+        return;
+
+    // the scope the binding was declared in is the last one which starts before it
+    unsigned long low = 0, high = stack->size;
+    while (high - low > 1)
+    {
+        unsigned long middle = (low + high) / 2;
+        if (stack->scope_starts[middle] <= binding - 1)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    unsigned long distance = stack->size - 1 - low;
+    symtable_stats.scope_hits++;
+    symtable_stats.scope_distance_total += distance;
+    if (distance > symtable_stats.scope_distance_max)
+        symtable_stats.scope_distance_max = distance;
+}
+#endif
+
 SymtableStack *SymtableStackInit(void)
 {
     SymtableStack *stack;
@@ -39,80 +72,91 @@ SymtableStack *SymtableStackInit(void)
     return stack;
 }
 
-Symtable *SymtableStackTop(SymtableStack *stack)
-{
-    return stack->size == 0 ? NULL : stack->top->table;
-}
-
 void SymtableStackRemoveTop(Parser *parser)
 {
     SymtableStack *stack = parser->symtable_stack;
     if (stack->size == 0)
         return; // do nothing if stack is empty
 
-    SymtableStackNode *previous_top = stack->top;
-    Symtable *s = previous_top->table;
-    for (unsigned long i = 0; i < s->capacity; i++)
+    // only the variables declared in the scope are checked, in the order they were declared in
+    for (int i = stack->scope_starts[stack->size - 1]; i < stack->binding_count; i++)
     {
-        if (s->table[i].is_occupied)
+        VariableSymbol *var = stack->bindings[i].symbol;
+        if (!var->was_used)
         {
-            // Check if the symbol is a variable
-            if (s->table[i].symbol_type == VARIABLE_SYMBOL)
-            {
-                VariableSymbol *var = (VariableSymbol *)s->table[i].symbol;
-
-                if (!var->was_used)
-                {
-                    PrintError("Warning: Variable '%s' was declared but never used. %d", var->name, parser->line_number);
-                    SymtableStackDestroy(parser->symtable_stack);
-                    DestroySymtable(parser->global_symtable);
-                    DestroyTokenVector(stream);
-                    exit(ERROR_SEMANTIC_UNUSED_VARIABLE);
-                }
-            }
+            PrintError("Warning: Variable '%s' was declared but never used. %d", var->name, parser->line_number);
+            SymtableStackDestroy(parser->symtable_stack);
+            DestroySymtable(parser->global_symtable);
+            DestroyStream();
+            exit(ERROR_SEMANTIC_UNUSED_VARIABLE);
         }
     }
 
-    stack->top = previous_top->next; // can also be NULL
-
-    // Free resources
-    DestroySymtable(previous_top->table);
-    free(previous_top);
-
-    --(stack->size);
+    SymtableStackPop(stack);
 }
 
 void SymtableStackPop(SymtableStack *stack)
 {
+    if (stack->size == 0)
+        return; // do nothing if stack is empty
 
-    if (stack->size != 0)
-    { // do nothing if stack is empty
-        SymtableStackNode *previous_top = stack->top;
-        stack->top = previous_top->next; // can also be NULL
-
-        // free resources
-        DestroySymtable(previous_top->table);
-        free(previous_top);
+    // undo the scope's declarations from the last one, every name gets back the binding it had before the scope
+    int start = stack->scope_starts[--(stack->size)];
+    while (stack->binding_count > start)
+    {
+        ScopeBinding *binding = &stack->bindings[--(stack->binding_count)];
+        stack->innermost[binding->symbol->symbol_id] = binding->shadowed;
+        DestroyVariableSymbol(binding->symbol);
+    }
+}
 
-        --(stack->size);
+void SymtableStackPush(SymtableStack *stack)
+{
+    if (stack->size + 1 > (unsigned long)stack->scope_capacity)
+    {
+        stack->scope_capacity = ALLOC_CHUNK(stack->scope_capacity);
+        if ((stack->scope_starts = realloc(stack->scope_starts, stack->scope_capacity * sizeof(int))) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
     }
+
+    // the scope starts empty, its bindings will be the ones appended from now on
+    stack->scope_starts[(stack->size)++] = stack->binding_count;
 }
 
-void SymtableStackPush(SymtableStack *stack, Symtable *symtable)
+void SymtableStackDeclare(SymtableStack *stack, VariableSymbol *variable_symbol)
 {
-    SymtableStackNode *node;
-    if ((node = malloc(sizeof(SymtableStackNode))) == NULL)
+    int symbol_id = variable_symbol->symbol_id;
+
+    // ids are dense, so the table of innermost bindings is just an array indexed by them
+    if (symbol_id >= stack->innermost_capacity)
     {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        int capacity = stack->innermost_capacity * 2 > symbol_id ? stack->innermost_capacity * 2 : symbol_id + 1;
+        if ((stack->innermost = realloc(stack->innermost, capacity * sizeof(int))) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
+
+        memset(stack->innermost + stack->innermost_capacity, 0, (capacity - stack->innermost_capacity) * sizeof(int));
+        stack->innermost_capacity = capacity;
+    }
+
+    if (stack->binding_count + 1 > stack->binding_capacity)
+    {
+        stack->binding_capacity = ALLOC_CHUNK(stack->binding_capacity);
+        if ((stack->bindings = realloc(stack->bindings, stack->binding_capacity * sizeof(ScopeBinding))) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
     }
 
-    // add data
-    node->next = stack->top;
-    node->table = symtable;
+    stack->bindings[stack->binding_count] = (ScopeBinding){variable_symbol, stack->innermost[symbol_id]};
+    stack->innermost[symbol_id] = ++(stack->binding_count);
 
-    // push onto the stack and increase size
-    stack->top = node;
-    ++(stack->size);
+    SYMTABLE_STAT(symtable_stats.declarations++);
+    SYMTABLE_STAT(if ((unsigned long)stack->binding_count > symtable_stats.peak_bindings) symtable_stats.peak_bindings = stack->binding_count);
+    SYMTABLE_STAT(if ((unsigned long)stack->innermost_capacity > symtable_stats.peak_innermost) symtable_stats.peak_innermost = stack->innermost_capacity);
 }
 
 void SymtableStackDestroy(SymtableStack *stack)
@@ -122,6 +166,9 @@ void SymtableStackDestroy(SymtableStack *stack)
         SymtableStackPop(stack);
     }
 
+    free(stack->innermost);
+    free(stack->bindings);
+    free(stack->scope_starts);
     free(stack);
 }
 
@@ -131,39 +178,62 @@ bool SymtableStackIsEmpty(SymtableStack *stack)
 }
 
 // function for finding a variable in the stack
-VariableSymbol *SymtableStackFindVariable(SymtableStack *stack, char *name)
+VariableSymbol *SymtableStackFindVariable(SymtableStack *stack, int symbol_id)
 {
     // For expression intermediate results which don't have a name
-    if (name == NULL)
+    if (symbol_id == NO_SYMBOL_ID)
         return NULL;
 
-    SymtableStackNode *current = stack->top;
-    while (current != NULL)
-    {
-        VariableSymbol *var = FindVariableSymbol(current->table, name);
-        if (var != NULL)
-            return var;
-        current = current->next;
-    }
-    return NULL;
+    // the innermost binding is the only one visible, no matter how deep the scope is (ids past the table were never declared)
+    int binding = symbol_id < stack->innermost_capacity ? stack->innermost[symbol_id] : 0;
+    SYMTABLE_STAT(CountScopeLookup(stack, binding));
+    return binding == 0 ? NULL : stack->bindings[binding - 1].symbol;
+}
+
+VariableSymbol *SymtableStackFindInTop(SymtableStack *stack, int symbol_id)
+{
+    VariableSymbol *var = SymtableStackFindVariable(stack, symbol_id);
+    if (var == NULL || stack->innermost[symbol_id] - 1 < stack->scope_starts[stack->size - 1])
+        return NULL;
+
+    return var;
 }
 
 void SymtableStackPrint(SymtableStack *stack)
 {
     fprintf(stdout, "Symtable stack:\n");
-    SymtableStackNode *current = stack->top;
-    while (current != NULL)
+    for (unsigned long scope = stack->size; scope-- > 0;)
     {
-        PrintTable(current->table);
-        current = current->next;
+        int end = scope + 1 == stack->size ? stack->binding_count : stack->scope_starts[scope + 1];
+        fprintf(stdout, "Scope %lu:\n", scope);
+        for (int i = stack->scope_starts[scope]; i < end; i++)
+        {
+            VariableSymbol *var = stack->bindings[i].symbol;
+            printf("Variable - Name: %s, Type: %d, Is Const: %s, Nullable: %s, Defined: %s\n",
+                   var->name,
+                   var->type,
+                   var->is_const ? "true" : "false",
+                   var->nullable ? "true" : "false",
+                   var->defined ? "true" : "false");
+        }
     }
 }
 
 /********************** EXPRESSION STACK OPERATIONS *********************/
 
+// The stack and tree of the last parsed expression, the next one takes them over with their arrays instead of growing new ones
+static ExpressionStack *spare_expression_stack = NULL;
+static ExpressionTree *spare_expression_tree = NULL;
+
 ExpressionStack *ExpressionStackInit(void)
 {
-    ExpressionStack *stack;
+    ExpressionStack *stack = spare_expression_stack;
+    if (stack != NULL)
+    {
+        spare_expression_stack = NULL;
+        return stack;
+    }
+
     if ((stack = calloc(1, sizeof(ExpressionStack))) == NULL)
     {
         ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
@@ -172,39 +242,20 @@ ExpressionStack *ExpressionStackInit(void)
     return stack;
 }
 
-ExpressionStackNode *ExpressionStackNodeInit(Token *token, STACK_NODE_TYPE node_type, PtableKey key)
+ExpressionStackNode *ExpressionStackTop(ExpressionStack *stack)
 {
-    ExpressionStackNode *node;
-    if ((node = calloc(1, sizeof(ExpressionStackNode))) == NULL)
-    {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-    }
-
-    node->token = token;
-    node->node_type = node_type;
-    node->key_type = key;
-
-    return node;
+    return stack->size == 0 ? NULL : &stack->nodes[stack->size - 1];
 }
 
-ExpressionStackNode *ExpressionStackTop(ExpressionStack *stack)
+ExpressionStackNode *ExpressionStackPeek(ExpressionStack *stack, unsigned long depth)
 {
-    return stack->size == 0 ? NULL : stack->top;
+    return depth >= stack->size ? NULL : &stack->nodes[stack->size - 1 - depth];
 }
 
 void ExpressionStackRemoveTop(ExpressionStack *stack)
 {
     if (stack->size != 0)
-    {
-        ExpressionStackNode *previous_top = stack->top;
-        stack->top = previous_top->next;
-        if (previous_top->token != NULL)
-            DestroyToken(previous_top->token);
-        // free allocated memory resources
-        free(previous_top);
-
         --(stack->size);
-    }
 }
 
 ExpressionStackNode *ExpressionStackPop(ExpressionStack *stack)
@@ -213,49 +264,53 @@ ExpressionStackNode *ExpressionStackPop(ExpressionStack *stack)
     if (stack->size == 0)
         return NULL;
 
-    // retrieve the top and pop it from the symtable
-    ExpressionStackNode *previous_top = stack->top;
-    stack->top = previous_top->next; // can also be NULL
-    --(stack->size);
-
-    return previous_top;
+    // the node stays in the array until something else is pushed
+    return &stack->nodes[--(stack->size)];
 }
 
 ExpressionStackNode *TopmostTerminal(ExpressionStack *stack)
 {
-    ExpressionStackNode *current = stack->top;
-    while (current != NULL)
-    {
-        if (current->node_type == TERMINAL)
-            return current;
-        current = current->next;
-    }
-    return NULL;
+    if (stack->size == 0 || stack->nodes[stack->size - 1].topmost_terminal == -1)
+        return NULL;
+
+    return &stack->nodes[stack->nodes[stack->size - 1].topmost_terminal];
 }
 
 int TopmostHandleDistance(ExpressionStack *stack)
 {
-    int distance = 0; // Should be already set to 0, but just in case
-    ExpressionStackNode *current = stack->top;
-    while (current != NULL)
-    {
-        if (current->node_type == HANDLE)
-            return distance;
+    if (stack->size == 0 || stack->nodes[stack->size - 1].topmost_handle == -1)
+        return -1; // No handle found, probably an error anyway?
 
-        ++distance;
-        current = current->next;
-    }
-    return -1; // No handle found, probably an error anyway?
+    return stack->size - 1 - stack->nodes[stack->size - 1].topmost_handle;
 }
 
-void ExpressionStackPush(ExpressionStack *stack, ExpressionStackNode *node)
+// Makes room for one more node
+static void ReserveExpressionStackNode(ExpressionStack *stack)
 {
-    // add data
-    node->next = stack->top;
+    if (stack->size + 1 > stack->capacity)
+    {
+        stack->capacity = stack->capacity == 0 ? 16 : stack->capacity * 2;
+        if ((stack->nodes = realloc(stack->nodes, stack->capacity * sizeof(ExpressionStackNode))) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
+    }
+}
 
-    // push to the stack and increase size
-    stack->top = node;
-    ++(stack->size);
+void ExpressionStackPush(ExpressionStack *stack, Token *token, STACK_NODE_TYPE node_type, PtableKey key)
+{
+    ReserveExpressionStackNode(stack);
+
+    // the node below knows the closest terminal and handle, unless this node is one of them itself
+    ExpressionStackNode *below = ExpressionStackTop(stack);
+    int index = stack->size++;
+    stack->nodes[index] = (ExpressionStackNode){
+        .token = token,
+        .node_type = node_type,
+        .key_type = key,
+        .topmost_terminal = node_type == TERMINAL ? index : (below == NULL ? -1 : below->topmost_terminal),
+        .topmost_handle = node_type == HANDLE ? index : (below == NULL ? -1 : below->topmost_handle),
+    };
 }
 
 void PushHandleAfterTopmost(ExpressionStack *stack)
@@ -265,57 +320,33 @@ void PushHandleAfterTopmost(ExpressionStack *stack)
     if (topmost == NULL)
         ErrorExit(ERROR_INTERNAL, "Stack has no terminals!");
 
-    // Create a new handle node
-    ExpressionStackNode *handle = ExpressionStackNodeInit(NULL, HANDLE, GetPtableKey(topmost->token, 1));
+    int position = topmost - stack->nodes + 1;
+    PtableKey key = GetPtableKey(topmost->token, 1);
+    ReserveExpressionStackNode(stack);
 
-    if (stack->top == topmost)
-    {
-        (++stack->size);
-        handle->next = stack->top;
-        stack->top = handle;
-        return;
-    }
-
-    // Insert the handle after the topmost terminal
-    ExpressionStackNode *current = stack->top;
-
-    while ((current->next != NULL) && (current->next != topmost))
-    {
-        current = current->next;
-    }
-
-    if (current->next == NULL)
-        ErrorExit(ERROR_INTERNAL, "Topmost terminal not found in the stack!");
+    // only nonterminals can be above the topmost terminal, they move up by one and the handle is now the closest one below them
+    memmove(&stack->nodes[position + 1], &stack->nodes[position], (stack->size - position) * sizeof(ExpressionStackNode));
+    stack->nodes[position] = (ExpressionStackNode){NULL, HANDLE, key, position - 1, position};
+    for (unsigned long i = position + 1; i <= stack->size; i++)
+        stack->nodes[i].topmost_handle = position;
 
-    current->next = handle;
-    handle->next = topmost;
     ++(stack->size);
 }
 
 void ExpressionStackDestroy(ExpressionStack *stack)
 {
-    while (stack->size != 0)
+    // the tokens belong to the token arena, the array is kept for the next expression
+    stack->size = 0;
+    if (spare_expression_stack == NULL)
     {
-        ExpressionStackRemoveTop(stack);
+        spare_expression_stack = stack;
+        return;
     }
 
+    free(stack->nodes);
     free(stack);
 }
 
-void ExpressionStackClear(ExpressionStack *stack, TokenVector *postfix)
-{
-    ExpressionStackNode *current = stack->top;
-    while (current != NULL)
-    {
-        if (current->token != NULL && !IsTokenInString(postfix, current->token))
-        {
-            DestroyToken(current->token);
-            current->token = NULL;
-        }
-        current = current->next;
-    }
-}
-
 bool ExpressionStackIsEmpty(ExpressionStack *stack)
 {
     return (stack->size) == 0;
@@ -324,102 +355,92 @@ bool ExpressionStackIsEmpty(ExpressionStack *stack)
 void ExpressionStackPrint(ExpressionStack *stack)
 {
     fprintf(stderr, "Expression stack:\n");
-    ExpressionStackNode *current = stack->top;
-    while (current != NULL)
+    for (unsigned long i = stack->size; i-- > 0;)
     {
+        ExpressionStackNode *current = &stack->nodes[i];
         if (current->node_type == TERMINAL)
         {
             fprintf(stderr, "Terminal: ");
-            current->token == NULL ? fprintf(stderr, "$\n") : fprintf(stderr, "%s\n", current->token->attribute);
+            current->token == NULL ? fprintf(stderr, "$\n") : fprintf(stderr, "%.*s\n", current->token->length, current->token->attribute);
         }
         else if (current->node_type == HANDLE)
             fprintf(stderr, "Handle\n");
         else
             fprintf(stderr, "Non-terminal\n");
-        current = current->next;
     }
 
     fprintf(stderr, "\n");
 }
 
-/********************** EVALUATION STACK OPERATIONS *********************/
+/********************** EXPRESSION TREE OPERATIONS *********************/
 
-EvaluationStack *EvaluationStackInit(void)
+ExpressionTree *ExpressionTreeInit(int length)
 {
-    EvaluationStack *stack;
-    if ((stack = calloc(1, sizeof(EvaluationStack))) == NULL)
+    ExpressionTree *tree = spare_expression_tree;
+    if (tree != NULL)
+        spare_expression_tree = NULL;
+
+    else if ((tree = calloc(1, sizeof(ExpressionTree))) == NULL)
     {
         ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
     }
 
-    return stack;
-}
-
-Token *EvaluationStackTop(EvaluationStack *stack)
-{
-    return stack->size == 0 ? NULL : stack->top->token;
-}
-
-void EvaluationStackRemoveTop(EvaluationStack *stack)
-{
-    if (stack->size != 0)
+    // one node per token of the postfix at most, so the arrays never grow while the tree is built
+    if (length > tree->capacity)
     {
-        EvaluationStackNode *previous_top = stack->top;
-        stack->top = previous_top->next;
-        // free allocated memory resources
-        if (previous_top->token != NULL)
-            DestroyToken(previous_top->token);
-        free(previous_top);
-
-        --(stack->size);
+        tree->capacity = length;
+        if ((tree->nodes = realloc(tree->nodes, length * sizeof(ExpressionNode))) == NULL ||
+            (tree->operands = realloc(tree->operands, length * sizeof(int))) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        }
     }
+
+    return tree;
 }
 
-void EvaluationStackPush(EvaluationStack *stack, Token *token)
+int ExpressionTreeAppend(ExpressionTree *tree, Token *token, bool is_operation)
 {
-    EvaluationStackNode *node;
-    if ((node = calloc(1, sizeof(EvaluationStackNode))) == NULL)
+    ExpressionNode *node = &tree->nodes[tree->length];
+    *node = (ExpressionNode){.token = token, .operator = token->token_type, .left = -1, .right = -1};
+
+    // an operation takes the two topmost nodes without a parent as its operands
+    if (is_operation)
     {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        node->right = tree->operands[--(tree->operand_count)];
+        node->left = tree->operands[--(tree->operand_count)];
     }
 
-    // add data
-    node->next = stack->top;
-    node->token = token;
-
-    // push to the stack and increase size
-    stack->top = node;
-    ++(stack->size);
+    tree->operands[(tree->operand_count)++] = tree->length;
+    return (tree->length)++;
 }
 
-Token *EvaluationStackPop(EvaluationStack *stack)
+void ExpressionTreeDestroy(ExpressionTree *tree)
 {
-    // look if the stack is not empty
-    if (stack->size == 0)
-        return NULL;
-
-    // retrieve the top
-    EvaluationStackNode *previous_top = stack->top;
-    stack->top = previous_top->next; // can also be NULL
-    --(stack->size);
-
-    Token *token = previous_top->token;
-    free(previous_top);
+    tree->length = tree->operand_count = 0;
+    if (spare_expression_tree == NULL)
+    {
+        spare_expression_tree = tree;
+        return;
+    }
 
-    return token;
+    free(tree->nodes);
+    free(tree->operands);
+    free(tree);
 }
 
-void EvaluationStackDestroy(EvaluationStack *stack)
+void ReleaseSpareStacks(void)
 {
-    while (stack->size != 0)
+    if (spare_expression_stack != NULL)
+        free(spare_expression_stack->nodes);
+    if (spare_expression_tree != NULL)
     {
-        EvaluationStackRemoveTop(stack);
+        free(spare_expression_tree->nodes);
+        free(spare_expression_tree->operands);
     }
 
-    free(stack);
+    free(spare_expression_stack);
+    free(spare_expression_tree);
+    spare_expression_stack = NULL;
+    spare_expression_tree = NULL;
 }
-
-bool EvaluationStackIsEmpty(EvaluationStack *stack)
-{
-    return (stack->size) == 0;
-}
\ No newline at end of file
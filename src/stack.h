@@ -5,8 +5,8 @@
  * This file defines stack operations used for expression parsing, managing
  * symbol tables for scope recognition, and evaluating expressions during
  * parsing. It includes the implementation of the symbol table stack,
- * expression stack, and evaluation stack, which are used to manage scopes,
- * handle operator precedence, and evaluate intermediate expressions. The
+ * expression stack, and the typed expression tree, which are used to manage scopes,
+ * handle operator precedence, and check and evaluate the parsed expressions. The
  * operations allow for pushing, popping, and querying elements from these
  * stacks, as well as clearing, printing, and destroying them.
  *
@@ -24,43 +24,47 @@
 #include "types.h" // Data types for the stack
 
 // ----Symtable stack operations---- //
+/* The scopes aren't a stack of hash tables, but a single table of the innermost binding of every variable name
+plus an undo log of the declarations. Finding a variable is one array access at any depth
+and closing a scope only touches the variables declared in it */
 
 /**
  * @brief Symtable stack constructor
  *
- * @return SymtableStack* Initialized stack instance
+ * @return SymtableStack* Initialized stack instance (without any scope)
  */
 SymtableStack *SymtableStackInit(void);
 
 /**
- * @brief Returns the element at the top of the stack
- *
- * @param stack Stack instance
- * @return Symtable* Symtable at the top of the stack, or NULL if stack is empty
- */
-Symtable *SymtableStackTop(SymtableStack *stack);
-
-/**
- * @brief Removes the symtable at the top of the stack, or does nothing if stack is empty
+ * @brief Closes the scope at the top of the stack, or does nothing if stack is empty
  *
  * @param parser Parser state
+ * @note Exits with ERROR_SEMANTIC_UNUSED_VARIABLE if a variable of the scope was never used
  */
 void SymtableStackRemoveTop(Parser *parser);
 
 /**
- * @brief Same as above but used just for destroying symtable
+ * @brief Same as above but without the check for unused variables, used just for destroying the stack
  *
  * @param stack Stack instance
  */
 void SymtableStackPop(SymtableStack *stack);
 
 /**
- * @brief Pushes a new symtable onto the top of the stack
+ * @brief Opens a new (empty) scope on the top of the stack
  *
  * @param stack Stack instance
- * @param symtable Table to be put onto the top
  */
-void SymtableStackPush(SymtableStack *stack, Symtable *symtable);
+void SymtableStackPush(SymtableStack *stack);
+
+/**
+ * @brief Declares a variable in the scope at the top of the stack, hiding any variable with the same name from the outer ones
+ *
+ * @param stack Stack instance with at least one scope
+ * @param variable_symbol The variable, its symbol_id has to be set. The stack frees it when the scope is closed
+ * @note Doesn't check for redefinitions, see InsertVariableSymbol()
+ */
+void SymtableStackDeclare(SymtableStack *stack, VariableSymbol *variable_symbol);
 
 // Symtable stack destructor
 void SymtableStackDestroy(SymtableStack *stack);
@@ -68,17 +72,22 @@ void SymtableStackDestroy(SymtableStack *stack);
 // To preserve the ADT type of the stack
 bool SymtableStackIsEmpty(SymtableStack *stack);
 
-// Function for finding a variable in the stack
-VariableSymbol *SymtableStackFindVariable(SymtableStack *stack, char *name);
+// Function for finding a variable with the given interned id (token->symbol_id) in the stack
+VariableSymbol *SymtableStackFindVariable(SymtableStack *stack, int symbol_id);
+
+// The same, but only finds variables declared in the scope at the top of the stack
+VariableSymbol *SymtableStackFindInTop(SymtableStack *stack, int symbol_id);
 
 void SymtableStackPrint(SymtableStack *stack);
 
 // ----Operations for expression stack (basically the same as for the symtable stack, just different data types)---- //
+/* Both expression stacks are arrays, a shift or a reduction doesn't allocate anything. Every node remembers
+the closest terminal and handle below it, so finding them doesn't walk the stack either */
 
 /**
  * @brief Expression stack constructor
  *
- * @return ExpressionStack* Initialized stack instance
+ * @return ExpressionStack* Empty stack instance, the one of the previous expression if it was destroyed (with its array)
  */
 ExpressionStack *ExpressionStackInit(void);
 
@@ -90,6 +99,15 @@ ExpressionStack *ExpressionStackInit(void);
  */
 ExpressionStackNode *ExpressionStackTop(ExpressionStack *stack);
 
+/**
+ * @brief Returns the node depth nodes below the stack top (0 is the top itself)
+ *
+ * @param stack Stack instance
+ * @param depth Number of nodes between the top and the returned one
+ * @return ExpressionStackNode* The node, or NULL if the stack isn't that high
+ */
+ExpressionStackNode *ExpressionStackPeek(ExpressionStack *stack, unsigned long depth);
+
 /**
  * @brief Returns the terminal symbol closest to the stack top
  *
@@ -114,16 +132,6 @@ int TopmostHandleDistance(ExpressionStack *stack);
  */
 void PushHandleAfterTopmost(ExpressionStack *stack);
 
-/**
- * @brief Initializes a new expression stack node
- *
- * @param token Token contained in the node
- * @param type Node type (terminal/non-terminal/handle)
- * @param key The key type to index into the table
- * @return ExpressionStackNode* Initialized node
- */
-ExpressionStackNode *ExpressionStackNodeInit(Token *token, STACK_NODE_TYPE type, PtableKey key);
-
 /**
  * @brief Removes the token at the top of the stack, or does nothing if stack is empty
  *
@@ -135,73 +143,53 @@ void ExpressionStackRemoveTop(ExpressionStack *stack);
  * @brief Removes an element at the top of the stack and returns it, or returns NULL if stack is empty
  *
  * @param stack Stack instance
- * @return Symtable* The top element, or NULL if stack is empty
+ * @return ExpressionStackNode* The top element (valid until the next push), or NULL if stack is empty
  */
 ExpressionStackNode *ExpressionStackPop(ExpressionStack *stack);
 
 /**
- * @brief Pushes a new token onto the top of the stack
+ * @brief Pushes a new node onto the top of the stack
  *
  * @param stack Stack instance
- * @param node Non-terminakl/Terminal to be put onto the top
+ * @param token Token contained in the node (NULL for the $ and nonterminals)
+ * @param node_type Node type (terminal/non-terminal/handle)
+ * @param key The key type to index into the table
  */
-void ExpressionStackPush(ExpressionStack *stack, ExpressionStackNode *node);
+void ExpressionStackPush(ExpressionStack *stack, Token *token, STACK_NODE_TYPE node_type, PtableKey key);
 
-// Expression stack destructor
+// Expression stack destructor, the stack (and its array) is kept for the next ExpressionStackInit()
 void ExpressionStackDestroy(ExpressionStack *stack);
 
-// Removes the tokens that are not in the postfix string from the stack
-void ExpressionStackClear(ExpressionStack *stack, TokenVector *postfix);
-
 // To preserve the ADT type of the stack
 bool ExpressionStackIsEmpty(ExpressionStack *stack);
 
 // Debug
 void ExpressionStackPrint(ExpressionStack *stack);
 
-// ----Evaluation stack operations---- //
+// ----Expression tree operations---- //
 
 /**
- * @brief Evaluation stack constructor
+ * @brief Expression tree constructor
  *
- * @return EvaluationStack* Initialized stack instance
+ * @param length Length of the postfix the tree is built from, the tree has room for that many nodes
+ * @return ExpressionTree* Empty tree instance, reused like the expression stack
  */
-EvaluationStack *EvaluationStackInit(void);
+ExpressionTree *ExpressionTreeInit(int length);
 
 /**
- * @brief Returns the element at the top of the stack
+ * @brief Appends the next token of a postfix expression to the tree
  *
- * @param stack Stack instance
- * @return Token* Token at the top of the stack, or NULL if stack is empty
+ * @param tree Tree instance
+ * @param token Operand or operator token
+ * @param is_operation If the token is a binary operator, its operands are the last two nodes without a parent
+ * @return int Index of the new node
  */
-Token *EvaluationStackTop(EvaluationStack *stack);
+int ExpressionTreeAppend(ExpressionTree *tree, Token *token, bool is_operation);
 
-/**
- * @brief Removes the token at the top of the stack, or does nothing if stack is empty
- *
- * @param stack Stack instance
- */
-void EvaluationStackRemoveTop(EvaluationStack *stack);
+// Expression tree destructor, the tree (and its arrays) is kept for the next ExpressionTreeInit()
+void ExpressionTreeDestroy(ExpressionTree *tree);
 
-/**
- * @brief Pushes a new token onto the top of the stack
- *
- * @param stack Stack instance
- * @param token Token to be put onto the top
- */
-void EvaluationStackPush(EvaluationStack *stack, Token *token);
-
-/**
- * @brief Pops the top element from the stack
- *
- * @param stack Stack instance
- */
-Token *EvaluationStackPop(EvaluationStack *stack);
-
-// Evaluation stack destructor
-void EvaluationStackDestroy(EvaluationStack *stack);
-
-// To preserve the ADT type of the stack
-bool EvaluationStackIsEmpty(EvaluationStack *stack);
+// Frees the expression stack and tree kept for the next expression, called at the end of the compilation
+void ReleaseSpareStacks(void);
 
 #endif
\ No newline at end of file
@@ -20,6 +20,79 @@
 #include "stack.h"
 #include "shared.h"
 #include "vector.h"
+#include "interner.h"
+#include "arena.h"
+
+// Every symbol comes from one of these, the symbols of a closed scope are reused by the next ones
+static Pool variable_pool = {.object_size = sizeof(VariableSymbol)};
+static Pool function_pool = {.object_size = sizeof(FunctionSymbol)};
+
+#if !defined(IFJ24_NO_SIMD) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define SYMTABLE_SSE2
+#include <immintrin.h>
+#endif
+
+#ifdef IFJ24_STATS
+SymtableStats symtable_stats = {0};
+
+// Counts a lookup of a table which looked at probes groups/slots
+static void CountProbes(TableStats *stats, unsigned long probes, bool hit)
+{
+    stats->lookups++;
+    stats->hits += hit;
+    stats->probes[probes < SYMTABLE_STATS_PROBE_BUCKETS ? probes - 1 : SYMTABLE_STATS_PROBE_BUCKETS - 1]++;
+}
+
+// Counts an insert into a table, which has size symbols in capacity slots after it
+static void CountInsert(TableStats *stats, unsigned long size, unsigned long capacity)
+{
+    stats->inserts++;
+    if (size > stats->peak_size)
+    {
+        stats->peak_size = size;
+        stats->peak_capacity = capacity;
+    }
+}
+
+static void PrintTableStats(const char *name, TableStats *stats)
+{
+    fprintf(stderr, "%s: %lu lookups (%lu hits), %lu inserts, %lu grows", name, stats->lookups, stats->hits, stats->inserts, stats->grows);
+    if (stats->tag_false_positives != 0)
+        fprintf(stderr, ", %lu tag false positives", stats->tag_false_positives);
+
+    fprintf(stderr, "\n  peak size %lu in %lu slots (load factor %.3f)\n  probe lengths:", stats->peak_size, stats->peak_capacity,
+            stats->peak_capacity == 0 ? 0.0 : (double)stats->peak_size / stats->peak_capacity);
+    for (int i = 0; i < SYMTABLE_STATS_PROBE_BUCKETS; i++)
+        fprintf(stderr, " %d%s: %lu", i + 1, i == SYMTABLE_STATS_PROBE_BUCKETS - 1 ? "+" : "", stats->probes[i]);
+    fprintf(stderr, "\n");
+}
+
+void PrintSymtableStats(void)
+{
+    PrintTableStats("Table of functions (probe length in groups of 16 slots)", &symtable_stats.functions);
+    PrintTableStats("Sets of local variables (probe length in slots)", &symtable_stats.variables);
+
+    unsigned long lookups = symtable_stats.scope_lookups, hits = symtable_stats.scope_hits;
+    fprintf(stderr, "Scopes: %lu lookups (%lu hits), %lu declarations, peak %lu visible variables, %lu ids in the innermost table\n",
+            lookups, hits, symtable_stats.declarations, symtable_stats.peak_bindings, symtable_stats.peak_innermost);
+    fprintf(stderr, "  open scopes per lookup: average %.2f, max %lu\n",
+            lookups == 0 ? 0.0 : (double)symtable_stats.scope_depth_total / lookups, symtable_stats.scope_depth_max);
+    fprintf(stderr, "  scopes between a hit and its declaration: average %.2f, max %lu\n",
+            hits == 0 ? 0.0 : (double)symtable_stats.scope_distance_total / hits, symtable_stats.scope_distance_max);
+}
+#endif
+
+// Allocates the control bytes and slots of a table with the given capacity, with every slot free
+static void AllocSymtableSlots(Symtable *symtable, unsigned long capacity)
+{
+    if ((symtable->control = malloc(capacity)) == NULL || (symtable->slots = malloc(capacity * sizeof(SymtableSlot))) == NULL)
+    {
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+    }
+
+    memset(symtable->control, SYMTABLE_EMPTY_SLOT, capacity);
+    symtable->capacity = capacity;
+}
 
 Symtable *InitSymtable(unsigned long size)
 {
@@ -29,97 +102,220 @@ Symtable *InitSymtable(unsigned long size)
         ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
     }
 
-    symtable->capacity = size;
+    // the slots are probed in whole groups and the index is masked instead of taking a modulo
+    unsigned long capacity = SYMTABLE_GROUP_SIZE;
+    while (capacity < size)
+        capacity *= 2;
+
     symtable->size = 0;
-    symtable->table = calloc(size, sizeof(HashEntry));
-    if (!symtable->table)
+    AllocSymtableSlots(symtable, capacity);
+
+    return symtable;
+}
+
+// Bit i of the result is set if the control byte of slot i of the group is byte
+static inline unsigned MatchGroup(const unsigned char *group, unsigned char byte)
+{
+#ifdef SYMTABLE_SSE2
+    __m128i control = _mm_loadu_si128((const __m128i *)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8((char)byte)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < SYMTABLE_GROUP_SIZE; i++)
     {
-        free(symtable);
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+        if (group[i] == byte)
+            mask |= 1u << i;
     }
 
-    for (unsigned long i = 0; i < size; i++)
+    return mask;
+#endif
+}
+
+// First group of slots the symbol with the given hash is looked for in, the following ones are probed after it
+static unsigned long FirstGroup(uint64_t hash, unsigned long capacity)
+{
+    return (hash >> 7) & (capacity - 1) & ~(unsigned long)(SYMTABLE_GROUP_SIZE - 1);
+}
+
+// Returns the first free slot a symbol with the given hash can be put to
+static unsigned long FindFreeSlot(Symtable *symtable, uint64_t hash)
+{
+    // there is always a free slot (see SYMTABLE_MAX_LOAD), so this ends
+    for (unsigned long group = FirstGroup(hash, symtable->capacity);; group = (group + SYMTABLE_GROUP_SIZE) & (symtable->capacity - 1))
     {
-        symtable->table[i].is_occupied = false;
-        symtable->table[i].symbol = NULL;
+        unsigned free_slots = MatchGroup(symtable->control + group, SYMTABLE_EMPTY_SLOT);
+        if (free_slots != 0)
+            return group + __builtin_ctz(free_slots);
     }
-
-    return symtable;
 }
 
-void DestroySymtable(Symtable *symtable)
+/**
+ * @brief Looks for the function with the given id, only the symbols whose tag matches are compared
+ *
+ * @return long Index of the function's slot, or -1 if it isn't in the table
+ */
+static long FindSlot(Symtable *symtable, int symbol_id, uint64_t hash)
 {
-    for (unsigned long i = 0; i < symtable->capacity; i++)
+    unsigned char tag = hash & 0x7F;
+    unsigned long first = FirstGroup(hash, symtable->capacity);
+    for (unsigned long group = first;; group = (group + SYMTABLE_GROUP_SIZE) & (symtable->capacity - 1))
     {
-        if (symtable->table[i].is_occupied && symtable->table[i].symbol)
+        unsigned matches = MatchGroup(symtable->control + group, tag);
+        while (matches != 0)
         {
-            if (symtable->table[i].symbol_type == FUNCTION_SYMBOL)
+            unsigned long index = group + __builtin_ctz(matches);
+            if (SYMBOL_IDS_EQUAL(symtable->slots[index].symbol_id, symbol_id))
             {
-
-                DestroyFunctionSymbol((FunctionSymbol *)symtable->table[i].symbol);
-            }
-            else if (symtable->table[i].symbol_type == VARIABLE_SYMBOL)
-            {
-                DestroyVariableSymbol((VariableSymbol *)symtable->table[i].symbol);
+                SYMTABLE_STAT(CountProbes(&symtable_stats.functions, ((group - first) & (symtable->capacity - 1)) / SYMTABLE_GROUP_SIZE + 1, true));
+                return index;
             }
+
+            SYMTABLE_STAT(symtable_stats.functions.tag_false_positives++);
+            matches &= matches - 1;
+        }
+
+        // nothing is ever removed from the table, so the symbol would have been put to this free slot
+        if (MatchGroup(symtable->control + group, SYMTABLE_EMPTY_SLOT) != 0)
+        {
+            SYMTABLE_STAT(CountProbes(&symtable_stats.functions, ((group - first) & (symtable->capacity - 1)) / SYMTABLE_GROUP_SIZE + 1, false));
+            return -1;
         }
     }
+}
 
-    free(symtable->table);
+// Doubles the number of slots of the symtable and moves every symbol to its slot in the new table
+static void GrowSymtable(Symtable *symtable)
+{
+    unsigned long old_capacity = symtable->capacity;
+    unsigned char *old_control = symtable->control;
+    SymtableSlot *old_slots = symtable->slots;
+    SYMTABLE_STAT(symtable_stats.functions.grows++);
+
+    AllocSymtableSlots(symtable, old_capacity * 2);
+    for (unsigned long i = 0; i < old_capacity; i++)
+    {
+        if (old_control[i] == SYMTABLE_EMPTY_SLOT)
+            continue;
+
+        // the tag stays the same, only the group changes
+        unsigned long index = FindFreeSlot(symtable, GetSymtableHash(old_slots[i].symbol_id));
+        symtable->control[index] = old_control[i];
+        symtable->slots[index] = old_slots[i];
+    }
+
+    free(old_control);
+    free(old_slots);
+}
+
+// Grows the symtable if inserting another symbol would make it too full, so that there's always a free slot to insert to
+static void ReserveSymtableSlot(Symtable *symtable)
+{
+    if (symtable->size + 1 > SYMTABLE_MAX_LOAD(symtable->capacity))
+        GrowSymtable(symtable);
+}
+
+void DestroySymtable(Symtable *symtable)
+{
+    for (unsigned long i = 0; i < symtable->capacity; i++)
+    {
+        if (symtable->control[i] != SYMTABLE_EMPTY_SLOT)
+            DestroyFunctionSymbol(symtable->slots[i].symbol);
+    }
+
+    free(symtable->control);
+    free(symtable->slots);
     free(symtable);
+
+    // the global symtable is always destroyed last (after the scopes), so no symbol from the pools is used after this
+    PoolRelease(&variable_pool);
+    PoolRelease(&function_pool);
 }
 
 void InitStringArray(StringArray *string_array)
 {
     string_array->count = 0;
     string_array->capacity = 10; // Initial capacity
-    string_array->strings = calloc(string_array->capacity, sizeof(char *));
-    if (!string_array->strings)
+    string_array->set_capacity = 32;
+    string_array->strings = calloc(string_array->capacity, sizeof(const char *));
+    string_array->ids = calloc(string_array->capacity, sizeof(int));
+    string_array->id_set = calloc(string_array->set_capacity, sizeof(int));
+    if (!string_array->strings || !string_array->ids || !string_array->id_set)
     {
         ErrorExit(ERROR_INTERNAL, "Memory allocation for string array failed");
     }
 }
 
-void AppendStringArray(StringArray *string_array, char *string)
+// Returns the slot of the id in the string array's set, or the free slot it would go to if it isn't there
+static int FindStringArraySlot(int *id_set, int set_capacity, int symbol_id)
+{
+    int index = GetSymtableHash(symbol_id) & (set_capacity - 1);
+    while (id_set[index] != NO_SYMBOL_ID && !SYMBOL_IDS_EQUAL(id_set[index], symbol_id))
+        index = (index + 1) & (set_capacity - 1);
+
+    return index;
+}
+
+// Doubles the set of the ids of the string array, the array itself (and so the order) stays the same
+static void GrowStringArraySet(StringArray *string_array)
+{
+    int set_capacity = string_array->set_capacity * 2;
+    SYMTABLE_STAT(symtable_stats.variables.grows++);
+    int *id_set = calloc(set_capacity, sizeof(int));
+    if (!id_set)
+    {
+        ErrorExit(ERROR_INTERNAL, "Memory reallocation for string array failed");
+    }
+
+    for (int i = 0; i < string_array->count; i++)
+        id_set[FindStringArraySlot(id_set, set_capacity, string_array->ids[i])] = string_array->ids[i];
+
+    free(string_array->id_set);
+    string_array->id_set = id_set;
+    string_array->set_capacity = set_capacity;
+}
+
+void AppendStringArray(StringArray *string_array, int symbol_id)
 {
+    // Check if the string is already in the array
+    int slot = FindStringArraySlot(string_array->id_set, string_array->set_capacity, symbol_id);
+    SYMTABLE_STAT(CountProbes(&symtable_stats.variables, ((slot - GetSymtableHash(symbol_id)) & (string_array->set_capacity - 1)) + 1,
+                              string_array->id_set[slot] != NO_SYMBOL_ID));
+    if (string_array->id_set[slot] != NO_SYMBOL_ID)
+    {
+        return; // String already in the array
+    }
+
     // Check if the vector needs to be resized
     if (string_array->count >= string_array->capacity)
     {
         size_t new_capacity = string_array->capacity * 2;
-        char **new_strings = realloc(string_array->strings, new_capacity * sizeof(char *));
-        if (!new_strings)
+        const char **new_strings = realloc(string_array->strings, new_capacity * sizeof(const char *));
+        int *new_ids = realloc(string_array->ids, new_capacity * sizeof(int));
+        if (!new_strings || !new_ids)
         {
             ErrorExit(ERROR_INTERNAL, "Memory reallocation for string array failed");
         }
         string_array->strings = new_strings;
+        string_array->ids = new_ids;
         string_array->capacity = new_capacity;
     }
 
-    // Check if the string is already in the array
-    for (int i = 0; i < string_array->count; i++)
-    {
-        if (strcmp(string_array->strings[i], string) == 0)
-        {
-            return; // String already in the array
-        }
-    }
-
-    // Add the string to the vector
-    string_array->strings[string_array->count] = strdup(string);
-    if (!string_array->strings[string_array->count])
-    {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation for string failed");
-    }
+    // Add the string to the vector, the interned name lives as long as the compilation
+    string_array->strings[string_array->count] = InternedName(symbol_id);
+    string_array->ids[string_array->count] = symbol_id;
     string_array->count++;
+
+    // and to the set, which is grown before it gets more than half full
+    string_array->id_set[slot] = symbol_id;
+    SYMTABLE_STAT(CountInsert(&symtable_stats.variables, string_array->count, string_array->set_capacity));
+    if (string_array->count * 2 > string_array->set_capacity)
+        GrowStringArraySet(string_array);
 }
 
 FunctionSymbol *FunctionSymbolInit(void)
 {
-    FunctionSymbol *function_symbol;
-    if ((function_symbol = calloc(1, sizeof(FunctionSymbol))) == NULL)
-    {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-    }
+    FunctionSymbol *function_symbol = PoolAlloc(&function_pool);
+    *function_symbol = (FunctionSymbol){0};
     InitStringArray(&function_symbol->variables);
 
     return function_symbol;
@@ -127,13 +323,8 @@ FunctionSymbol *FunctionSymbolInit(void)
 
 VariableSymbol *VariableSymbolInit(void)
 {
-    VariableSymbol *variable_symbol;
-    if ((variable_symbol = calloc(1, sizeof(VariableSymbol))) == NULL)
-    {
-        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
-    }
-
-    variable_symbol->type = VOID_TYPE; // Default
+    VariableSymbol *variable_symbol = PoolAlloc(&variable_pool);
+    *variable_symbol = (VariableSymbol){.type = VOID_TYPE}; // Default
 
     return variable_symbol;
 }
@@ -144,7 +335,8 @@ VariableSymbol *VariableSymbolCopy(VariableSymbol *var)
 
     copy->defined = var->defined;
     copy->is_const = var->is_const;
-    copy->name = var->name == NULL ? NULL : strdup(var->name);
+    copy->name = var->name;
+    copy->symbol_id = var->symbol_id;
     copy->nullable = var->nullable;
     copy->type = var->type;
 
@@ -156,9 +348,6 @@ void DestroyFunctionSymbol(FunctionSymbol *function_symbol)
     if (function_symbol == NULL)
         return; // just in case
 
-    if (function_symbol->name != NULL)
-        free(function_symbol->name);
-
     // free all parameters
     for (int i = 0; i < function_symbol->num_of_parameters; i++)
     {
@@ -168,18 +357,15 @@ void DestroyFunctionSymbol(FunctionSymbol *function_symbol)
         }
     }
 
-    // free the array of variables
-    for (int i = 0; i < function_symbol->variables.count; i++)
-    {
-        free(function_symbol->variables.strings[i]);
-    }
-
+    // free the array of variables, the names themselves are interned
     free(function_symbol->variables.strings);
+    free(function_symbol->variables.ids);
+    free(function_symbol->variables.id_set);
 
     if (function_symbol->parameters != NULL)
         free(function_symbol->parameters);
 
-    free(function_symbol);
+    PoolFree(&function_pool, function_symbol);
 }
 
 void DestroyVariableSymbol(VariableSymbol *variable_symbol)
@@ -187,25 +373,17 @@ void DestroyVariableSymbol(VariableSymbol *variable_symbol)
     if (variable_symbol == NULL)
         return;
 
-    if (variable_symbol->name != NULL)
-        free(variable_symbol->name);
-
     if (variable_symbol->value != NULL)
         free(variable_symbol->value);
 
-    free(variable_symbol);
+    PoolFree(&variable_pool, variable_symbol);
 }
 
-unsigned long GetSymtableHash(char *symbol_name, unsigned long modulo)
+uint64_t GetSymtableHash(int symbol_id)
 {
-    unsigned int hash = 0;
-    const unsigned char *p;
-    for (p = (const unsigned char *)symbol_name; *p != '\0'; p++)
-    {
-        hash = 65599 * hash + *p;
-    }
-
-    return hash % modulo;
+    // ids are dense, the multiplication (Fibonacci hashing) spreads consecutive ones over all the groups and tags
+    uint64_t hash = (uint64_t)(unsigned)symbol_id * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
 }
 
 bool IsSymtableEmpty(Symtable *symtable)
@@ -213,124 +391,52 @@ bool IsSymtableEmpty(Symtable *symtable)
     return symtable->size == 0;
 }
 
-FunctionSymbol *FindFunctionSymbol(Symtable *symtable, char *function_name)
+FunctionSymbol *FindFunctionSymbol(Symtable *symtable, int symbol_id)
 {
-    unsigned long index = GetSymtableHash(function_name, symtable->capacity);
-    unsigned long start_index = index;
+    // nameless tokens (literals, results of expressions...) are never a symbol
+    if (symbol_id == NO_SYMBOL_ID)
+        return NULL;
 
-    while (symtable->table[index].is_occupied)
-    {
-        if (symtable->table[index].symbol_type == FUNCTION_SYMBOL &&
-            strcmp(((FunctionSymbol *)symtable->table[index].symbol)->name, function_name) == 0)
-        {
-            return (FunctionSymbol *)symtable->table[index].symbol;
-        }
-
-        index = (index + 1) % symtable->capacity;
-        if (index == start_index)
-        {
-            break;
-        }
-    }
-
-    return NULL;
-}
-
-VariableSymbol *FindVariableSymbol(Symtable *symtable, char *variable_name)
-{
-    unsigned long index = GetSymtableHash(variable_name, symtable->capacity);
-    unsigned long start_index = index;
-
-    while (symtable->table[index].is_occupied)
-    {
-        if (symtable->table[index].symbol_type == VARIABLE_SYMBOL &&
-            strcmp(((VariableSymbol *)symtable->table[index].symbol)->name, variable_name) == 0)
-        {
-            return (VariableSymbol *)symtable->table[index].symbol;
-        }
-
-        index = (index + 1) % symtable->capacity;
-        if (index == start_index)
-        {
-            break; // Avoid infinite loop
-        }
-    }
-
-    return NULL; // Symbol not found
+    long index = FindSlot(symtable, symbol_id, GetSymtableHash(symbol_id));
+    return index == -1 ? NULL : symtable->slots[index].symbol;
 }
 
 void InsertVariableSymbol(Parser *parser, VariableSymbol *variable_symbol)
 {
-    unsigned long index = GetSymtableHash(variable_symbol->name, parser->symtable->capacity);
-    unsigned long start_index = index;
+    int symbol_id = variable_symbol->symbol_id;
 
-    if (SymtableStackFindVariable(parser->symtable_stack, variable_symbol->name) != NULL || FindFunctionSymbol(parser->global_symtable, variable_symbol->name) != NULL)
+    // a variable can't have the name of any visible variable (even from an outer scope) or of a function
+    if (SymtableStackFindVariable(parser->symtable_stack, symbol_id) != NULL || FindFunctionSymbol(parser->global_symtable, symbol_id) != NULL)
     {
-        // Symbol already in table
+        // Symbol already in table, the message goes first since the name is released with the stream
+        PrintError("Variable already %s declared on line %d", variable_symbol->name, parser->line_number);
         SymtableStackDestroy(parser->symtable_stack);
         DestroySymtable(parser->global_symtable);
-        DestroyTokenVector(stream);
-        ErrorExit(ERROR_SEMANTIC_REDEFINED, "Variable already %s declared on line %d", variable_symbol->name, parser->line_number);
+        DestroyStream();
+        exit(ERROR_SEMANTIC_REDEFINED);
     }
 
-    while (parser->symtable->table[index].is_occupied)
-    {
-        if (parser->symtable->table[index].symbol_type == VARIABLE_SYMBOL &&
-            strcmp(((VariableSymbol *)parser->symtable->table[index].symbol)->name, variable_symbol->name) == 0)
-        {
-            // Symbol already exists
-            SymtableStackDestroy(parser->symtable_stack);
-            DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
-            ErrorExit(ERROR_SEMANTIC_REDEFINED, "Variable already %s declared on line %d", variable_symbol->name, parser->line_number);
-        }
-
-        index = (index + 1) % parser->symtable->capacity;
-        if (index == start_index)
-        {
-            // Table is full
-            SymtableStackDestroy(parser->symtable_stack);
-            DestroySymtable(parser->global_symtable);
-            DestroyTokenVector(stream);
-            ErrorExit(ERROR_INTERNAL, "Symbol table is full");
-        }
-    }
-
-    parser->symtable->table[index].symbol_type = VARIABLE_SYMBOL;
-    parser->symtable->table[index].symbol = variable_symbol;
-    parser->symtable->table[index].is_occupied = true;
-    parser->symtable->size++;
+    SymtableStackDeclare(parser->symtable_stack, variable_symbol);
 }
 
 bool InsertFunctionSymbol(Parser *parser, FunctionSymbol *function_symbol)
 {
-    unsigned long index = GetSymtableHash(function_symbol->name, parser->global_symtable->capacity);
-    unsigned long start_index = index;
+    int symbol_id = function_symbol->symbol_id;
 
-    if (SymtableStackFindVariable(parser->symtable_stack, function_symbol->name) != NULL || FindFunctionSymbol(parser->global_symtable, function_symbol->name) != NULL)
+    if (SymtableStackFindVariable(parser->symtable_stack, symbol_id) != NULL || FindFunctionSymbol(parser->global_symtable, symbol_id) != NULL)
     {
         return false; // Symbol already in table
     }
 
-    while (parser->global_symtable->table[index].is_occupied)
-    {
-        if (parser->global_symtable->table[index].symbol_type == FUNCTION_SYMBOL &&
-            strcmp(((FunctionSymbol *)parser->global_symtable->table[index].symbol)->name, function_symbol->name) == 0)
-        {
-            return false; // Symbol already exists
-        }
-
-        index = (index + 1) % parser->global_symtable->capacity;
-        if (index == start_index)
-        {
-            return false; // Table is full
-        }
-    }
+    Symtable *symtable = parser->global_symtable;
+    ReserveSymtableSlot(symtable);
 
-    parser->global_symtable->table[index].symbol_type = FUNCTION_SYMBOL;
-    parser->global_symtable->table[index].symbol = function_symbol;
-    parser->global_symtable->table[index].is_occupied = true;
-    parser->global_symtable->size++;
+    uint64_t hash = GetSymtableHash(symbol_id);
+    unsigned long index = FindFreeSlot(symtable, hash);
+    symtable->control[index] = hash & 0x7F;
+    symtable->slots[index] = (SymtableSlot){symbol_id, function_symbol};
+    symtable->size++;
+    SYMTABLE_STAT(CountInsert(&symtable_stats.functions, symtable->size, symtable->capacity));
 
     return true;
 }
@@ -340,25 +446,11 @@ void PrintTable(Symtable *symtable)
     printf("Symbol Table:\n");
     for (unsigned long i = 0; i < symtable->capacity; i++)
     {
-        if (symtable->table[i].is_occupied)
+        if (symtable->control[i] != SYMTABLE_EMPTY_SLOT)
         {
-            printf("Index %lu: ", i);
-            if (symtable->table[i].symbol_type == FUNCTION_SYMBOL)
-            {
-                FunctionSymbol *func = (FunctionSymbol *)symtable->table[i].symbol;
-                printf("Function - Name: %s, Return Type: %d, Parameters: %d\n",
-                       func->name, func->return_type, func->num_of_parameters);
-            }
-            else if (symtable->table[i].symbol_type == VARIABLE_SYMBOL)
-            {
-                VariableSymbol *var = (VariableSymbol *)symtable->table[i].symbol;
-                printf("Variable - Name: %s, Type: %d, Is Const: %s, Nullable: %s, Defined: %s\n",
-                       var->name,
-                       var->type,
-                       var->is_const ? "true" : "false",
-                       var->nullable ? "true" : "false",
-                       var->defined ? "true" : "false");
-            }
+            FunctionSymbol *func = symtable->slots[i].symbol;
+            printf("Index %lu (tag %02x): Function - Name: %s, Return Type: %d, Parameters: %d\n",
+                   i, symtable->control[i], func->name, func->return_type, func->num_of_parameters);
         }
         else
         {
@@ -7,8 +7,11 @@
  * functions for managing symbols (both variables and functions).
  *
  * ### Notes:
- * - The hash function used for the symtable is based on the sdbm variant from
- *   http://www.cse.yorku.ca/~oz/hash.html.
+ * - Symbols are keyed on the interned ids of their names (see interner.h), the names themselves are only
+ *   hashed once by the interner (sdbm variant from http://www.cse.yorku.ca/~oz/hash.html).
+ * - The table of functions is a swiss table: every slot has a control byte with 7 bits of the hash of its symbol,
+ *   a lookup compares the control bytes of 16 slots at once (SSE2, scalar with -DIFJ24_NO_SIMD)
+ *   and only looks at the symbols whose tag matches.
  *
  * @authors
  * - Boris Semanco [xseman06]
@@ -19,29 +22,82 @@
 
 #include "types.h"
 
-// symtable constructor with the specified size of linked lists
+// The symtable statistics are only counted with make STATS=1 (-DIFJ24_STATS), in the debug build as well
+#ifdef IFJ24_STATS
+#define SYMTABLE_STAT(statement) \
+    do                           \
+    {                            \
+        statement;               \
+    } while (0)
+#else
+#define SYMTABLE_STAT(statement) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
+
+// Probe lengths 1 to SYMTABLE_STATS_PROBE_BUCKETS - 1 get their own bucket in the histogram, the last one counts all the longer ones
+#define SYMTABLE_STATS_PROBE_BUCKETS 8
+
+// Counters of one kind of hash table, for the sets of variables they are summed over all the functions
+typedef struct
+{
+    unsigned long lookups;
+    unsigned long hits;
+    unsigned long inserts;
+    unsigned long probes[SYMTABLE_STATS_PROBE_BUCKETS]; // Lookups by the number of groups (slots in the sets of variables) they looked at
+    unsigned long tag_false_positives;                  // Slots whose tag matched but the symbol didn't (swiss table only)
+    unsigned long grows;
+    unsigned long peak_size;     // Most symbols in one table
+    unsigned long peak_capacity; // Slots of that table at the time
+} TableStats;
+
+/**
+ * @brief Counters of the symtable and the scope stack, only there with IFJ24_STATS
+ *
+ * Printed to stderr with PrintSymtableStats() when the compiler exits (also on errors, see PrintStats() in core_parser.c)
+ */
+typedef struct
+{
+    TableStats functions; // The global table of functions
+    TableStats variables; // The sets of the functions' local variables (StringArray)
+    unsigned long scope_lookups;
+    unsigned long scope_hits;
+    unsigned long scope_distance_total; // Sum over the hits of the number of scopes between the innermost one and the declaration
+    unsigned long scope_distance_max;   // (which is how many scopes a stack of tables would have searched)
+    unsigned long scope_depth_total;    // Sum over the lookups of the number of open scopes
+    unsigned long scope_depth_max;
+    unsigned long declarations;
+    unsigned long peak_bindings; // Most variables visible at once
+    unsigned long peak_innermost;
+} SymtableStats;
+
+extern SymtableStats symtable_stats;
+
+// Prints the symtable counters to stderr
+void PrintSymtableStats(void);
+
+// symtable constructor with at least the specified initial number of slots (rounded up to a power of two), the table grows when it gets too full
 Symtable *InitSymtable(unsigned long size);
 
-// symtable destructor, calls DestroyList on every SymtableLinkedList
+// symtable destructor, destroys every function symbol in the table and releases the memory of all the symbols
 void DestroySymtable(Symtable *symtable);
 
 /**
  * @brief Hash function for the symtable (which is a Hash table)
  *
- * @param symbol_name name of the symbol, used as an input to the hash function
- * @param modulo size of the symtable, the index into the symtable is H(x) % size
- * @note This function is from http://www.cse.yorku.ca/~oz/hash.html -- sdbm variant
- * @return unsigned long index into the symtable
+ * @param symbol_id interned id of the symbol's name
+ * @return uint64_t hash of the id, the low 7 bits are the slot's tag and the rest picks the group the probing starts at
  */
-unsigned long GetSymtableHash(char *symbol_name, unsigned long modulo);
+uint64_t GetSymtableHash(int symbol_id);
 
-// FunctionSymbol symbol constructor
+// FunctionSymbol symbol constructor, the symbol comes from a pool which is released by DestroySymtable()
 FunctionSymbol *FunctionSymbolInit(void);
 
-// VariableSymbol symbol constructor
+// VariableSymbol symbol constructor, the symbol comes from a pool which is released by DestroySymtable()
 VariableSymbol *VariableSymbolInit(void);
 
-// Returns a copy of the variable symbol passed as a param to avoid double frees
+// Returns a copy of the variable symbol passed as a param to avoid double frees (the interned name is shared)
 VariableSymbol *VariableSymbolCopy(VariableSymbol *var);
 
 // FunctionSymbol symbol destructor
@@ -53,17 +109,14 @@ void DestroyVariableSymbol(VariableSymbol *variable_symbol);
 // better than if(symtable -> size == 0)
 bool IsSymtableEmpty(Symtable *symtable);
 
-// looks if the symbol is in the symtable and returns a pointer to it if yes, else returns NULL
-FunctionSymbol *FindFunctionSymbol(Symtable *symtable, char *function_name);
-
-// the same but for variables
-VariableSymbol *FindVariableSymbol(Symtable *symtable, char *variable_name);
+// looks if the symbol with the given interned id (token->symbol_id) is in the symtable and returns a pointer to it if yes, else returns NULL
+FunctionSymbol *FindFunctionSymbol(Symtable *symtable, int symbol_id);
 
 /**
- * @brief Inserts a variable symbol into the symtable
+ * @brief Declares a variable symbol in the scope at the top of the symtable stack, exits if the name is already taken
  *
  * @param parser Pointer to parser structure
- * @param variable_symbol Pointer to the symbol to insert
+ * @param variable_symbol Pointer to the symbol to insert, its symbol_id has to be set
  */
 void InsertVariableSymbol(Parser *parser, VariableSymbol *variable_symbol);
 
@@ -80,6 +133,6 @@ void PrintTable(Symtable *symtable);
 
 // Initializes a string array
 void InitStringArray(StringArray *string_array);
-// Appends a string to the string array
-void AppendStringArray(StringArray *string_array, char *string);
+// Appends a copy of the interned string with the given id to the string array, if it isn't there already (checked in O(1) with the array's set of ids)
+void AppendStringArray(StringArray *string_array, int symbol_id);
 #endif
\ No newline at end of file
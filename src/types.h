@@ -17,9 +17,20 @@
 #define TYPES_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-// Symtable size
-#define TABLE_COUNT 5009 // first prime over 5000
+// Initial symtable size (one group of slots), tables grow as needed (see SYMTABLE_MAX_LOAD)
+#define SYMTABLE_INITIAL_CAPACITY 16
+
+// A symtable is grown (doubled and rehashed) before more than 7/8 of its slots would be occupied
+#define SYMTABLE_MAX_LOAD(capacity) ((capacity) / 8 * 7)
+
+// Number of slots whose control bytes are compared at once, one SSE2 register
+#define SYMTABLE_GROUP_SIZE 16
+
+// Control byte of a free symtable slot, the occupied ones hold a 7 bit tag (so the top bit is never set)
+#define SYMTABLE_EMPTY_SLOT 0x80
 
 // Number of precedence table rows/columns
 #define PTABLE_SIZE 14
@@ -97,32 +108,91 @@ typedef enum
     NONE, // not a keyword, assigned to token if the token's type != KEYWORD
 } KEYWORD_TYPE;
 
-// enum for symbol types
+// character classes of the scanner's DFA, every byte of the input belongs to exactly one of them
 typedef enum
 {
-    NUMBER,
-    CHARACTER,
-    WHITESPACE,
-    OTHER,
-} CHAR_TYPE;
+    CLASS_INVALID,     // can't start a token (also every non-ASCII byte)
+    CLASS_DIGIT,       // 1-9
+    CLASS_ZERO,        // a separate class since numbers can't start with multiple zeroes
+    CLASS_LETTER,      // [a-zA-Z] except for e/E
+    CLASS_EXPONENT,    // e/E, the only letters which can also continue a number
+    CLASS_UNDERSCORE,  // _
+    CLASS_WHITESPACE,  // the same characters as isspace() in the "C" locale
+    CLASS_QUOTE,       // "
+    CLASS_BACKSLASH,   // start of a multi-line literal
+    CLASS_SLASH,       // division or a comment
+    CLASS_EQUALS,      // =, ==
+    CLASS_LESS,        // <, <=
+    CLASS_GREATER,     // >, >=
+    CLASS_EXCLAMATION, // !=
+    CLASS_QUESTION,    // ?i32, ?[]u8, ...
+    CLASS_L_SQUARE,    // []u8
+    CLASS_AT,          // @import
+    CLASS_DOT,
+    CLASS_PLUS,
+    CLASS_MINUS,
+    CLASS_ASTERISK,
+    CLASS_L_ROUND,
+    CLASS_R_ROUND,
+    CLASS_L_CURLY,
+    CLASS_R_CURLY,
+    CLASS_VERTICAL_BAR,
+    CLASS_SEMICOLON,
+    CLASS_COLON,
+    CLASS_COMMA,
+    CLASS_COUNT        // not a class, has to stay last (and below 32, classes are also used as bit positions)
+} CHAR_CLASS;
+
+// states of the scanner's DFA after reading the first character of a token
+typedef enum
+{
+    STATE_INVALID,           // invalid token
+    STATE_SINGLE_CHAR,       // a complete one character token
+    STATE_OPERATOR,          // =, <, >, ! which can be followed by a '='
+    STATE_SLASH,             // division operator or the start of a comment
+    STATE_IDENTIFIER,        // identifier/keyword
+    STATE_PREFIX,            // ? before a type
+    STATE_NUMBER,            // i32/f64 literal
+    STATE_ZERO,              // number starting with a zero
+    STATE_LITERAL,           // "string"
+    STATE_MULTILINE_LITERAL, // multi-line literal
+    STATE_U8,                // []u8
+    STATE_IMPORT,            // @import
+    STATE_WHITESPACE,        // skipped
+} SCANNER_STATE;
+
+// Binary value of a number literal, parsed once by the scanner
+typedef union
+{
+    int64_t integer; // INTEGER_32 tokens
+    double floating; // DOUBLE_64 tokens
+} NumberValue;
+
+struct VariableSymbol;
 
 // token structure
 typedef struct
 {
     TOKEN_TYPE token_type;
     KEYWORD_TYPE keyword_type; // KEYWORD_TYPE.NONE if token_type != KEYWORD
-    char *attribute;           // String representation of the token
+    const char *attribute;     // String representation of the token, NOT NUL-terminated (a view into the source or into the token arena)
+    int length;                // Number of characters in the attribute
     int line_number;           // Useful when ungetting tokens
+    int symbol_id;             // Interned id of the name for identifiers, NO_SYMBOL_ID (0) for other tokens
+    NumberValue value;         // Value of number literals, the code generator prints this instead of the attribute
+    struct VariableSymbol *variable; // Symbol an identifier in an expression is bound to, set once by ResolveIdentifiers()
 } Token;
 
-// Symbols and symtables
-// symbol type enumeration
-typedef enum
+// The whole source program, loaded at once so that the scanner can look ahead without ungetc()
+typedef struct
 {
-    FUNCTION_SYMBOL,
-    VARIABLE_SYMBOL
-} SYMBOL_TYPE;
+    const char *data; // Program text, not NUL-terminated if it's mapped
+    size_t length;    // Number of bytes in data
+    size_t position;  // Index of the next unread character
+    bool is_mapped;   // True if data comes from mmap(), false if it was read into a malloc'd buffer
+} SourceBuffer;
 
+// Symbols and symtables
 // IFJ24 data types
 typedef enum
 {
@@ -141,29 +211,36 @@ typedef enum
 // ********************HASH TABLE****************************** //
 
 // structure of a variable symbol
-typedef struct
+typedef struct VariableSymbol
 {
-    char *name;
-    char *value; // for constants
+    const char *name; // the interned name, not owned by the symbol
+    int symbol_id; // interned id of the name, what the symtables compare instead of the name
+    char *value;   // for constants
+    NumberValue const_value; // binary value of numeric constants, valid if value != NULL or folded
     DATA_TYPE type;
     bool is_const;
     bool nullable;
     bool defined;
     bool was_used;
+    bool folded; // a constant whose initializer was folded into const_value, which is only used for folding (value stays NULL)
 } VariableSymbol;
 
-// String array to store variables for functions
+// String array to store variables for functions, in the order they were appended in
 typedef struct
 {
-    char **strings;
+    const char **strings; // the interned names
+    int *ids;             // interned ids of the strings
     int count;
     int capacity;
+    int *id_set;      // Hash set of the ids (open addressing, NO_SYMBOL_ID is a free slot), so an append doesn't scan the array
+    int set_capacity; // Power of two, the set is kept at most half full
 } StringArray;
 
 // structure of a function symbol
 typedef struct
 {
-    char *name;
+    const char *name; // the interned name, not owned by the symbol
+    int symbol_id;    // interned id of the name
     int num_of_parameters;
     VariableSymbol **parameters;
     DATA_TYPE return_type;
@@ -171,18 +248,20 @@ typedef struct
     StringArray variables;
 } FunctionSymbol;
 
+// Slot of the table of functions, the id is kept next to the symbol so that a probe doesn't have to look into it
 typedef struct
 {
-    SYMBOL_TYPE symbol_type;
-    void *symbol;
-    bool is_occupied; // True if the slot is occupied
-} HashEntry;
+    int symbol_id;
+    FunctionSymbol *symbol;
+} SymtableSlot;
 
+// Table of the functions, a swiss table: the control bytes of the slots are probed a group (16 slots) at a time
 typedef struct
 {
-    unsigned long capacity; // Maximum number of entries
-    unsigned long size;     // Current number of occupied entries
-    HashEntry *table;       // Array of hash entries
+    unsigned long capacity; // Number of slots, a power of two and a multiple of SYMTABLE_GROUP_SIZE
+    unsigned long size;     // Current number of occupied slots
+    unsigned char *control; // SYMTABLE_EMPTY_SLOT or the tag (low 7 bits of the hash) of the slot's symbol
+    SymtableSlot *slots;    // slots[i] is only valid if control[i] isn't empty
 } Symtable;
 
 /******************** VECTOR (DYNAMIC ARRAY) STRUCTURES ********************/
@@ -203,6 +282,70 @@ typedef struct
     int capacity;         // max
 } TokenVector;
 
+// Text of a token in the TokenStream
+typedef struct
+{
+    const char *data; // View into the source or into the token arena, NOT NUL-terminated
+    int length;
+    NumberValue value; // Token.value of number literals
+} TokenAttribute;
+
+// The token stream shared by both passes, kept as parallel arrays so that scanning it only touches the needed fields
+typedef struct
+{
+    uint8_t *token_types;            // TOKEN_TYPE of each token
+    uint8_t *keyword_types;          // KEYWORD_TYPE of each token
+    uint32_t *line_numbers;          // Line of each token
+    uint32_t *attributes;            // Interned id for identifiers (unless identifier_text), else an index into attribute_table (0 if the token type gives the text)
+    int length;                      // Number of tokens
+    int capacity;                    // Allocated size of the four arrays above
+    TokenAttribute *attribute_table; // The attributes which aren't implied by the token type, entry 0 is unused
+    int attribute_count;
+    int attribute_capacity;
+    bool identifier_text; // Identifiers keep their text in attribute_table, set on the parallel scanner's chunks (which can't intern)
+} TokenStream;
+
+/******************** ARENA (BUMP ALLOCATOR) STRUCTURES ********************/
+
+// One chunk of arena memory, the chunks are chained so that they can be freed all at once
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next; // Previously filled block
+    size_t capacity;         // Usable bytes in data
+    size_t used;             // Bytes handed out so far
+    char data[];
+} ArenaBlock;
+
+// Memory which is only ever released as a whole
+typedef struct
+{
+    ArenaBlock *head; // Block which is currently being filled, NULL if nothing was allocated yet
+} Arena;
+
+// Allocator of objects of a single size carved out of an arena, freed objects are reused by the next allocations
+typedef struct
+{
+    Arena arena;        // Where the new objects come from
+    void *free_list;    // Freed objects, each one holds the pointer to the next one in its first bytes
+    size_t object_size; // At least sizeof(void *)
+} Pool;
+
+/******************** PARALLEL SCANNER STRUCTURES ********************/
+
+// A part of the source scanned by one thread of the parallel scanner, every chunk but the first starts right after a '\n'
+typedef struct
+{
+    size_t start;          // First byte of the chunk
+    size_t end;            // The chunk has the tokens starting before this byte (the start of the next chunk)
+    int newlines;          // Number of '\n' characters between start and end
+    TokenStream *tokens;   // Tokens of the chunk, identifiers aren't interned and keep their text in the attribute table
+    int *scan_lines;       // Line counter of the scanner after each token, lines are counted from the start of the chunk
+    Arena attributes;      // Owns the attributes which aren't views into the source
+    bool failed;           // A lexical error was found in the chunk, the tokens before it are still valid
+    size_t error_position; // Start of the faulty token, the serial scanner continues from here to report the error
+    int error_line;        // Line of the faulty token, counted from the start of the chunk
+} SourceChunk;
+
 /******************** STRUCTURES FOR PRECEDENTIAL ANALYSIS ********************/
 
 // Enumeration of grammar rules for reduction in expressions
@@ -223,6 +366,13 @@ typedef enum
     NOT_FOUND_RULE       // Rule not found, error
 } EXPRESSION_RULE;
 
+// Algorithms InfixToPostfix() can convert an expression with, both give the same postfix
+typedef enum
+{
+    TABLE_ENGINE, // Shift/reduce with the precedence table
+    PRECEDENCE_ENGINE // Shunting-yard, an operator stack with binding powers, one pass without reductions
+} EXPRESSION_ENGINE;
+
 typedef enum
 {
     PTABLE_ID,
@@ -256,16 +406,23 @@ typedef PtableValue PrecedenceTable[PTABLE_SIZE][PTABLE_SIZE];
 
 /********************* STACK STRUCTURES ********************/
 
-typedef struct SymStackNode
-{ // Linked list for symtable stack implementation
-    Symtable *table;
-    struct SymStackNode *next;
-} SymtableStackNode;
+// One variable declared in a scope, the bindings of all open scopes are kept in declaration order
+typedef struct
+{
+    VariableSymbol *symbol;
+    int shadowed; // Index + 1 of the binding of the same name in an outer scope which this one hides, 0 if there's none
+} ScopeBinding;
 
 typedef struct
-{ // Stack for symtables
-    unsigned long size;
-    SymtableStackNode *top;
+{ // The "stack" of scopes, one flat table of the innermost binding of each name plus an undo log of the declarations
+    unsigned long size;     // Number of open scopes
+    int *innermost;         // Index + 1 of the innermost binding of each symbol id (0 = not declared), indexed by the id itself
+    int innermost_capacity; // Length of the innermost array, grows with the highest declared id
+    ScopeBinding *bindings; // Bindings of every open scope, closing a scope undoes the ones after its start
+    int binding_count;
+    int binding_capacity;
+    int *scope_starts; // Index of the first binding of each open scope
+    int scope_capacity;
 } SymtableStack;
 
 typedef enum
@@ -275,31 +432,52 @@ typedef enum
     NONTERMINAL // There don't need to bne multiple types for this, since we only have one non-terminal -> E
 } STACK_NODE_TYPE;
 
-typedef struct ExprStackNode
-{ // Linked list for expression parser stack implementation
+typedef struct
+{ // One symbol on the expression parser's stack
     Token *token;
     STACK_NODE_TYPE node_type;
     PtableKey key_type;
-    struct ExprStackNode *next;
+    int topmost_terminal; // Index of the closest terminal at or below this node, so the stack is never walked to find it
+    int topmost_handle;   // The same for handles, -1 if there's none
 } ExpressionStackNode;
 
 typedef struct
-{ // Stack for expression parsing
+{ // Stack for expression parsing, one array which the next expression reuses (see ExpressionStackInit())
     unsigned long size;
-    ExpressionStackNode *top;
+    unsigned long capacity;
+    ExpressionStackNode *nodes; // The bottom of the stack is nodes[0]
 } ExpressionStack;
 
-typedef struct EvalStackNode
-{ // Linked list for evaluation stack implementation
-    Token *token;
-    struct EvalStackNode *next;
-} EvaluationStackNode;
+typedef enum
+{                    // Conversion of one operand of a binary operation, done on the data stack right before it
+    NO_CONVERSION,
+    LEFT_INT2FLOAT,  // The left operand is under the right one, so the right one waits in GF@$F0
+    RIGHT_INT2FLOAT,
+    LEFT_FLOAT2INT,  // The right one waits in GF@$R0
+    RIGHT_FLOAT2INT
+} OPERAND_CONVERSION;
 
 typedef struct
-{ // Stack for expression evaluation
-    unsigned long size;
-    EvaluationStackNode *top;
-} EvaluationStack;
+{ // Node of a typed expression tree, either an operand or a binary operation
+    Token *token;        // The operand, or the operator (an arithmetic one becomes the token of its result when checked)
+    TOKEN_TYPE operator; // The operator's token type, which the rewritten token no longer has
+    DATA_TYPE type;      // Resolved type, BOOLEAN for relational operations
+    bool nullable;
+    bool is_const;       // Value known at compile time (literals, constants with a value and operations on them)
+    OPERAND_CONVERSION conversion;
+    int left;            // Indexes of the operands, -1 in operand nodes (and in folded operations, see FoldExpressionTree())
+    int right;
+    bool absorbed;       // Operand of a folded operation, nothing is generated for it
+} ExpressionNode;
+
+typedef struct
+{ // Typed expression tree, reused by the next expression like the stacks
+    int length;
+    int capacity;
+    ExpressionNode *nodes; // In postfix order, so the operands of a node come before it and the root is the last one
+    int *operands;         // Nodes without a parent yet, only used while the tree is built
+    int operand_count;
+} ExpressionTree;
 
 /******************** ENUM FOR IFJCODE24 FRAMES ********************/
 typedef enum
@@ -318,9 +496,8 @@ typedef struct
     bool parsing_functions;
     bool end_of_program;
     FunctionSymbol *current_function;
-    Symtable *symtable;        // Current symtable (top of the stack), local variables
-    Symtable *global_symtable; // Only for functions
-    SymtableStack *symtable_stack;
+    Symtable *global_symtable;     // Only for functions
+    SymtableStack *symtable_stack; // Local variables of all the open scopes
 } Parser;
 
 #endif
\ No newline at end of file
@@ -19,6 +19,9 @@
 #include "vector.h"
 #include "error.h"
 #include "scanner.h"
+#include "shared.h"
+#include "interner.h"
+#include "parallel_scan.h"
 
 Vector *InitVector()
 {
@@ -49,6 +52,29 @@ void AppendChar(Vector *vector, char c)
     (vector->value)[vector->length++] = c;
 }
 
+void AppendChars(Vector *vector, const char *string, int count)
+{
+    if (count == 0)
+        return;
+
+    // grow the same way AppendChar does, just possibly more times over
+    if (vector->length + count > vector->max_length)
+    {
+        int capacity = vector->max_length;
+        while (vector->length + count > capacity)
+            capacity = ALLOC_CHUNK(capacity);
+
+        if ((vector->value = realloc(vector->value, sizeof(char) * capacity)) == NULL)
+        {
+            ErrorExit(ERROR_INTERNAL, "Compiler internal error: Memory allocation failed");
+        }
+        vector->max_length = capacity;
+    }
+
+    memcpy(vector->value + vector->length, string, count);
+    vector->length += count;
+}
+
 TokenVector *InitTokenVector()
 {
     TokenVector *vector;
@@ -68,7 +94,6 @@ void AppendToken(TokenVector *vector, Token *input_token)
 
         if ((vector->token_string = realloc(vector->token_string, new_capacity * sizeof(Token *))) == NULL)
         {
-            DestroyToken(input_token);
             ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
         }
 
@@ -86,17 +111,162 @@ void AppendToken(TokenVector *vector, Token *input_token)
 
 void DestroyTokenVector(TokenVector *vector)
 {
-    if (vector->length != 0)
+    // the tokens are owned by the token arena, the vector only holds pointers to them
+    free(vector->token_string);
+    free(vector);
+}
+
+// Texts of the token types which always look the same, such tokens don't need an entry in the attribute table
+static const char *const fixed_attributes[TOKEN_COUNT] = {
+    [UNDERSCORE_TOKEN] = "_",
+    [IMPORT_TOKEN] = "@import",
+    [ASSIGNMENT] = "=",
+    [MULTIPLICATION_OPERATOR] = "*",
+    [DIVISION_OPERATOR] = "/",
+    [ADDITION_OPERATOR] = "+",
+    [SUBSTRACTION_OPERATOR] = "-",
+    [EQUAL_OPERATOR] = "==",
+    [NOT_EQUAL_OPERATOR] = "!=",
+    [LESS_THAN_OPERATOR] = "<",
+    [LARGER_THAN_OPERATOR] = ">",
+    [LESSER_EQUAL_OPERATOR] = "<=",
+    [LARGER_EQUAL_OPERATOR] = ">=",
+    [L_ROUND_BRACKET] = "(",
+    [R_ROUND_BRACKET] = ")",
+    [L_CURLY_BRACKET] = "{",
+    [R_CURLY_BRACKET] = "}",
+    [VERTICAL_BAR_TOKEN] = "|",
+    [SEMICOLON] = ";",
+    [COMMA_TOKEN] = ",",
+    [DOT_TOKEN] = ".",
+    [COLON_TOKEN] = ":",
+};
+
+TokenStream *InitTokenStream()
+{
+    TokenStream *stream;
+    if ((stream = calloc(1, sizeof(TokenStream))) == NULL)
+    {
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+    }
+
+    // entry 0 of the attribute table is never used, so that 0 can mean "no entry"
+    stream->attribute_count = 1;
+    return stream;
+}
+
+// Grows one of the stream's arrays, exits if there is no memory left
+static void *GrowArray(void *array, int capacity, size_t element_size)
+{
+    if ((array = realloc(array, capacity * element_size)) == NULL)
+    {
+        ErrorExit(ERROR_INTERNAL, "Memory allocation failed");
+    }
+
+    return array;
+}
+
+void StreamAppendToken(TokenStream *stream, Token *token)
+{
+    if (stream->length + 1 > stream->capacity)
+    {
+        stream->capacity = ALLOC_CHUNK(stream->capacity);
+        stream->token_types = GrowArray(stream->token_types, stream->capacity, sizeof(uint8_t));
+        stream->keyword_types = GrowArray(stream->keyword_types, stream->capacity, sizeof(uint8_t));
+        stream->line_numbers = GrowArray(stream->line_numbers, stream->capacity, sizeof(uint32_t));
+        stream->attributes = GrowArray(stream->attributes, stream->capacity, sizeof(uint32_t));
+    }
+
+    // only the attributes which can't be derived from the token type are stored, identifiers just keep their interned id
+    // (in the parallel scanner's chunks they aren't interned yet, those keep their text like other tokens)
+    uint32_t attribute = 0;
+    const char *fixed = fixed_attributes[token->token_type];
+    if (token->token_type == IDENTIFIER_TOKEN && !stream->identifier_text)
+        attribute = token->symbol_id;
+
+    else if (fixed == NULL ? token->attribute != NULL : !AttributeEquals(token, fixed))
     {
-        for (int i = 0; i < vector->capacity; i++)
+        if (stream->attribute_count + 1 > stream->attribute_capacity)
         {
-            if (vector->token_string[i] != NULL)
-            {
-                DestroyToken(vector->token_string[i]);
-            }
+            stream->attribute_capacity = stream->attribute_count * 2;
+            stream->attribute_table = GrowArray(stream->attribute_table, stream->attribute_capacity, sizeof(TokenAttribute));
         }
+
+        attribute = stream->attribute_count++;
+        stream->attribute_table[attribute] = (TokenAttribute){token->attribute, token->length, token->value};
     }
 
-    free(vector->token_string);
-    free(vector);
+    stream->token_types[stream->length] = token->token_type;
+    stream->keyword_types[stream->length] = token->keyword_type;
+    stream->line_numbers[stream->length] = token->line_number;
+    stream->attributes[stream->length] = attribute;
+    stream->length++;
+}
+
+TOKEN_TYPE StreamTokenType(TokenStream *stream, int index)
+{
+    return stream->token_types[index];
+}
+
+KEYWORD_TYPE StreamKeywordType(TokenStream *stream, int index)
+{
+    return stream->keyword_types[index];
+}
+
+int StreamLineNumber(TokenStream *stream, int index)
+{
+    return stream->line_numbers[index];
+}
+
+Token *StreamToken(TokenStream *stream, int index)
+{
+    Token *token = InitToken();
+    token->token_type = stream->token_types[index];
+    token->keyword_type = stream->keyword_types[index];
+    token->line_number = stream->line_numbers[index];
+
+    uint32_t attribute = stream->attributes[index];
+    if (token->token_type == IDENTIFIER_TOKEN && !stream->identifier_text)
+    {
+        token->symbol_id = attribute;
+        token->attribute = InternedName(attribute);
+        token->length = InternedLength(attribute);
+    }
+
+    else if (attribute != 0)
+    {
+        token->attribute = stream->attribute_table[attribute].data;
+        token->length = stream->attribute_table[attribute].length;
+        token->value = stream->attribute_table[attribute].value;
+    }
+
+    else if (fixed_attributes[token->token_type] != NULL)
+    {
+        token->attribute = fixed_attributes[token->token_type];
+        token->length = strlen(token->attribute);
+    }
+
+    return token;
+}
+
+void DestroyTokenStream(TokenStream *stream)
+{
+    free(stream->token_types);
+    free(stream->keyword_types);
+    free(stream->line_numbers);
+    free(stream->attributes);
+    free(stream->attribute_table);
+    free(stream);
+}
+
+void DestroyStream()
+{
+    DestroyTokenStream(stream);
+    stream = NULL;
+
+    // the prescanned chunks are only left over if the first pass ends with an error
+    ReleasePrescan();
+
+    // every token of the compilation is released here, including the ones created by StreamToken() and the parser's copies
+    ReleaseTokens();
 }
@@ -23,6 +23,15 @@
  */
 void AppendChar(Vector *vector, char c);
 
+/**
+ * @brief Appends count characters at once, reallocating at most once
+ *
+ * @param vector Pointer to the vector
+ * @param string Characters to append, don't have to be NUL-terminated
+ * @param count Number of characters to append
+ */
+void AppendChars(Vector *vector, const char *string, int count);
+
 /**
  * @brief Allocates a new vector pointer
  *
@@ -42,6 +51,39 @@ TokenVector *InitTokenVector();
 
 void AppendToken(TokenVector *vector, Token *input_token);
 
+// Frees the vector itself, the tokens in it are owned by the token arena
 void DestroyTokenVector(TokenVector *vector);
 
+// Token stream functions
+TokenStream *InitTokenStream();
+
+/**
+ * @brief Appends a copy of the token to the stream, the token itself isn't referenced afterwards
+ *
+ * @param stream The stream to append to
+ * @param token The token to copy, its attribute has to stay valid as long as the stream (a view into the source or the token arena)
+ */
+void StreamAppendToken(TokenStream *stream, Token *token);
+
+// Accessors for a single field of the token at index, these don't create a Token
+TOKEN_TYPE StreamTokenType(TokenStream *stream, int index);
+KEYWORD_TYPE StreamKeywordType(TokenStream *stream, int index);
+int StreamLineNumber(TokenStream *stream, int index);
+
+/**
+ * @brief Builds a Token out of the stream entry at index
+ *
+ * @note In a stream with identifier_text set (a chunk of the parallel scanner), identifiers come back with their text
+ *       and NO_SYMBOL_ID, the caller has to intern them (see ChunkToken() in parallel_scan.c)
+ *
+ * @return Token* A new token in the token arena, changing it doesn't affect the stream
+ */
+Token *StreamToken(TokenStream *stream, int index);
+
+// Frees the stream's arrays, the attributes are owned by the source and the token arena
+void DestroyTokenStream(TokenStream *stream);
+
+// Destroys the global token stream and releases all tokens of the compilation (see ReleaseTokens())
+void DestroyStream();
+
 #endif
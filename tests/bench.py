@@ -0,0 +1,126 @@
+import argparse
+import os
+import subprocess
+import tempfile
+import time
+
+# Generates a large, valid IFJ24 program and measures how fast the compiler processes it.
+# Usage (from the src folder, same as test.py): python3 ../tests/bench.py [--functions N] [--runs R] [--binary PATH]
+# Expression parsers are compared with: python3 ../tests/bench.py --expressions 50 --compiler-args="-e precedence" (and "-e table")
+
+HEADER = 'const ifj = @import("ifj24.zig");\n\n'
+
+FUNCTION = '''// Function number {i}, exercises most of the token kinds the scanner knows about
+pub fn compute{i}(a: i32, b: f64, s: []u8) i32 {{
+    var x: i32 = a * 3 + 7 - (a / 2);
+    const k: i32 = 42;
+    var y: f64 = b * 2.5 + 1.0e2 - 0.125;
+    var text: []u8 = ifj.string("escapes: \\"quoted\\" \\n \\x41\\x42 tab\\t end");
+    var block: []u8 = ifj.string(
+        \\\\ this literal spans
+        \\\\ multiple lines
+    );
+    ifj.write(text);
+    ifj.write(block);
+    ifj.write(s);
+
+    // loop with a nested condition
+    var counter: i32 = 0;
+    while (counter < x) {{
+        counter = counter + k;
+        if (counter >= 100) {{
+            ifj.write("big\\n");
+        }} else {{
+            ifj.write("small\\n");
+        }}
+    }}
+
+    if (y > 10.0) {{
+        ifj.write(y);
+    }} else {{
+        ifj.write("no");
+    }}
+
+    return counter + x;
+}}
+
+'''
+
+# Scanner-heavy filler, inserted into every function when --padding is used
+PADDING = '''    // padding comment line, only the scanner ever looks at this text: 0123456789 abcdefghij
+    ifj.write("padding literal with an \\x41 escape and some more text to scan through {i}\\n");
+'''
+
+# Expression-heavy filler, inserted before the return of every function when --expressions is used
+EXPRESSION = '''    x = (a * 3 + 7) * (a - 2) / 5 + a * a - (x + {i}) * 2 + ((a + 1) * (a - 1) - x / 3) * 4 - (((k))) * (counter + 1);
+'''
+
+MAIN_BEGIN = 'pub fn main() void {\n    var result: i32 = 0;\n'
+MAIN_CALL = '    result = compute{i}({i}, 1.5, "argument");\n    ifj.write(result);\n'
+MAIN_END = '    return;\n}\n'
+
+
+def generate(functions, padding, expressions=0):
+    parts = [HEADER]
+    for i in range(functions):
+        function = FUNCTION.format(i=i)
+        if padding:
+            # insert the filler right after the function header
+            header_end = function.index('{\n') + 2
+            function = function[:header_end] + PADDING.format(i=i) * padding + function[header_end:]
+        if expressions:
+            return_start = function.index('    return')
+            function = function[:return_start] + EXPRESSION.format(i=i) * expressions + function[return_start:]
+        parts.append(function)
+    parts.append(MAIN_BEGIN)
+    for i in range(functions):
+        parts.append(MAIN_CALL.format(i=i))
+    parts.append(MAIN_END)
+    return ''.join(parts)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='IFJ24 compiler throughput benchmark')
+    parser.add_argument('--functions', type=int, default=4000, help='number of generated functions')
+    parser.add_argument('--runs', type=int, default=5, help='number of timed runs, the best one is reported')
+    parser.add_argument('--binary', default='./ifj24', help='path to the compiler executable')
+    parser.add_argument('--padding', type=int, default=0, help='scanner-only filler lines per function')
+    parser.add_argument('--expressions', type=int, default=0, help='expression-heavy lines per function')
+    parser.add_argument('--compiler-args', default='', help='arguments passed to the compiler, e.g. "-e precedence"')
+    parser.add_argument('--emit', help='only write the generated program to this path and exit')
+    args = parser.parse_args()
+
+    source = generate(args.functions, args.padding, args.expressions)
+    if args.emit:
+        with open(args.emit, 'w') as file:
+            file.write(source)
+        return
+
+    with tempfile.NamedTemporaryFile('w', suffix='.ifj24', delete=False) as file:
+        file.write(source)
+        path = file.name
+
+    try:
+        best = None
+        for _ in range(args.runs):
+            with open(path, 'rb') as input_file:
+                start = time.perf_counter()
+                result = subprocess.run([args.binary] + args.compiler_args.split(), stdin=input_file, stdout=subprocess.DEVNULL,
+                                        stderr=subprocess.PIPE)
+                elapsed = time.perf_counter() - start
+
+            if result.returncode != 0:
+                print(f'Compiler exited with code {result.returncode}: {result.stderr.decode(errors="replace")}')
+                return
+
+            best = elapsed if best is None else min(best, elapsed)
+
+        size = os.path.getsize(path)
+        print(f'Input: {size / (1024 * 1024):.2f} MiB, {args.functions} functions')
+        print(f'Best of {args.runs}: {best * 1000:.1f} ms, {size / (1024 * 1024) / best:.2f} MiB/s')
+    finally:
+        os.remove(path)
+
+
+if __name__ == '__main__':
+    main()
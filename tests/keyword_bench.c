@@ -0,0 +1,110 @@
+/**
+ * @file keyword_bench.c
+ * @brief Microbenchmark for the keyword classification in the scanner (IsKeyword)
+ *
+ * Scans the given IFJ24 program, collects every identifier/keyword token and then classifies
+ * them over and over, once with IsKeyword() and once with the old linear strcmp() loop for comparison.
+ * Build and run from the src folder: make keyword-bench && ./keyword_bench ../tests/some_file.ifj24
+ * (an identifier heavy program can be generated with python3 ../tests/bench.py --emit file.ifj24)
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scanner.h"
+
+// How many times the whole corpus is classified
+#define ROUNDS 200
+
+// The original implementation, compares the identifier against every keyword
+static KEYWORD_TYPE LinearIsKeyword(const char *attribute, int length)
+{
+    const char keyword_strings[][KEYWORD_COUNT] = {
+        "const", "else", "fn", "if", "i32", "f64", "null", "pub", "return", "u8", "var", "void", "while"};
+
+    if (length > 0 && attribute[0] == '?')
+        return LinearIsKeyword(attribute + 1, length - 1);
+
+    if (length >= KEYWORD_COUNT)
+        return NONE;
+
+    for (int i = 0; i < KEYWORD_COUNT; i++)
+    {
+        if (!strncmp(attribute, keyword_strings[i], length) && keyword_strings[i][length] == '\0')
+            return i;
+    }
+
+    return NONE;
+}
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file.ifj24\n", argv[0]);
+        return 1;
+    }
+
+    LoadSource(argv[1]);
+
+    // Collect the identifier/keyword tokens, they stay valid until the source is destroyed and the tokens are released
+    int count = 0, capacity = 1024, line_number = 1;
+    Token **corpus = malloc(capacity * sizeof(Token *));
+    Token *token;
+    while ((token = LoadTokenFromStream(&line_number))->token_type != EOF_TOKEN)
+    {
+        if ((token->token_type != IDENTIFIER_TOKEN && token->token_type != KEYWORD) || token->keyword_type == U8)
+            continue;
+
+        if (count == capacity)
+            corpus = realloc(corpus, (capacity *= 2) * sizeof(Token *));
+        corpus[count++] = token;
+    }
+
+    // Both implementations have to agree, otherwise the numbers don't mean anything
+    for (int i = 0; i < count; i++)
+    {
+        if (IsKeyword(corpus[i]->attribute, corpus[i]->length) != LinearIsKeyword(corpus[i]->attribute, corpus[i]->length))
+        {
+            fprintf(stderr, "Mismatch on \"%.*s\"\n", corpus[i]->length, corpus[i]->attribute);
+            return 1;
+        }
+    }
+
+    // volatile so that the loops aren't optimized away
+    volatile unsigned long keywords = 0;
+
+    double start = Seconds();
+    for (int round = 0; round < ROUNDS; round++)
+        for (int i = 0; i < count; i++)
+            keywords += LinearIsKeyword(corpus[i]->attribute, corpus[i]->length) != NONE;
+    double linear = Seconds() - start;
+
+    start = Seconds();
+    for (int round = 0; round < ROUNDS; round++)
+        for (int i = 0; i < count; i++)
+            keywords += IsKeyword(corpus[i]->attribute, corpus[i]->length) != NONE;
+    double hashed = Seconds() - start;
+
+    double total = (double)count * ROUNDS;
+    printf("%d identifiers/keywords (%lu keywords), %d rounds\n", count, keywords / (2 * ROUNDS), ROUNDS);
+    printf("strcmp loop:  %.2f ns per lookup\n", linear / total * 1e9);
+    printf("perfect hash: %.2f ns per lookup (%.1fx)\n", hashed / total * 1e9, linear / hashed);
+
+    free(corpus);
+    ReleaseTokens();
+    DestroySource();
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file scanner_bench.c
+ * @brief Throughput benchmark for the scanner alone (without the parser and the code generation)
+ *
+ * Loads the given IFJ24 program and tokenizes it a few times, reporting the best run in MiB/s.
+ * Build and run from the src folder: make scanner-bench && ./scanner_bench file.ifj24 [runs] [threads]
+ * (with more than one thread, the tokens come from the parallel scanner like with ifj24 -j)
+ * (a large program can be generated with python3 ../tests/bench.py --emit file.ifj24)
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "scanner.h"
+#include "parallel_scan.h"
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file.ifj24 [runs] [threads]\n", argv[0]);
+        return 1;
+    }
+
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+    SetScanThreads(argc > 3 ? atoi(argv[3]) : 1);
+    double best = 0;
+    long tokens = 0, bytes = 0;
+
+    for (int run = 0; run < runs; run++)
+    {
+        // the source is loaded again every run, so the time includes mapping/reading it
+        double start = Seconds();
+        LoadSource(argv[1]);
+        PrescanSource();
+
+        int line_number = 1;
+        tokens = 0;
+        Token *token;
+        while ((token = ScanToken(&line_number))->token_type != EOF_TOKEN)
+        {
+            tokens++;
+            RecycleTokens();
+        }
+        ReleasePrescan();
+        ReleaseTokens();
+        DestroySource();
+
+        double elapsed = Seconds() - start;
+        if (run == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        bytes = ftell(file);
+        fclose(file);
+    }
+
+    printf("%ld tokens, %.2f MiB\n", tokens, bytes / (1024.0 * 1024.0));
+    printf("Best of %d: %.2f ms, %.1f MiB/s\n", runs, best * 1000, bytes / (1024.0 * 1024.0) / best);
+
+    return 0;
+}
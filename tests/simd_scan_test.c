@@ -0,0 +1,161 @@
+/**
+ * @file simd_scan_test.c
+ * @brief Differential test of the scalar, SSE2 and AVX2 variants of the scanner's vectorized helpers
+ *
+ * Every variant has to return exactly what the scalar one returns (and count the same newlines), for random
+ * buffers of random lengths, tails shorter than a vector and runs which end exactly at a block boundary.
+ * The buffers are allocated with their exact length, so the sanitizers catch a read past the end.
+ * Build and run from the src folder: make simd-test (a variant the CPU doesn't support is skipped)
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The variants are static, so they are tested from the same translation unit
+#include "simd_scan.c"
+
+// Random buffers and the longest of them
+#define RANDOM_BUFFERS 200000
+#define MAX_LENGTH 160
+
+typedef struct
+{
+    const char *name;
+    size_t (*skip_whitespace)(const char *, size_t, size_t, int *);
+    size_t (*find_line_end)(const char *, size_t, size_t);
+    size_t (*find_literal_stop)(const char *, size_t, size_t);
+} ScanVariant;
+
+static ScanVariant variants[3];
+static int variant_count = 0;
+static unsigned long checks = 0;
+static int failures = 0;
+
+static void AddVariants(void)
+{
+    variants[variant_count++] = (ScanVariant){"scalar", SkipWhitespaceScalar, FindLineEndScalar, FindLiteralStopScalar};
+
+#ifdef SIMD_SCAN_X86
+    variants[variant_count++] = (ScanVariant){"sse2", SkipWhitespaceSSE2, FindLineEndSSE2, FindLiteralStopSSE2};
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        variants[variant_count++] = (ScanVariant){"avx2", SkipWhitespaceAVX2, FindLineEndAVX2, FindLiteralStopAVX2};
+    else
+        fprintf(stderr, "simd_scan_test: the CPU has no AVX2, skipping the avx2 variant\n");
+#endif
+}
+
+static void ReportFailure(const char *function, const char *variant, const char *data, size_t position, size_t length,
+                          size_t expected, size_t got, int expected_lines, int got_lines)
+{
+    if (++failures > 10)
+        return;
+
+    fprintf(stderr, "%s (%s) differs at position %zu of %zu: expected %zu (%d newlines), got %zu (%d newlines), buffer:",
+            function, variant, position, length, expected, expected_lines, got, got_lines);
+    for (size_t i = 0; i < length; i++)
+        fprintf(stderr, " %02x", (unsigned char)data[i]);
+    fputc('\n', stderr);
+}
+
+// Runs every helper of every variant from the given position and compares them with the scalar one
+static void CheckPosition(const char *data, size_t position, size_t length)
+{
+    int expected_lines = 0;
+    size_t expected_skip = variants[0].skip_whitespace(data, position, length, &expected_lines);
+    size_t expected_line_end = variants[0].find_line_end(data, position, length);
+    size_t expected_stop = variants[0].find_literal_stop(data, position, length);
+
+    for (int i = 1; i < variant_count; i++)
+    {
+        int lines = 0;
+        size_t got = variants[i].skip_whitespace(data, position, length, &lines);
+        if (got != expected_skip || lines != expected_lines)
+            ReportFailure("SkipWhitespace", variants[i].name, data, position, length, expected_skip, got, expected_lines, lines);
+
+        got = variants[i].find_line_end(data, position, length);
+        if (got != expected_line_end)
+            ReportFailure("FindLineEnd", variants[i].name, data, position, length, expected_line_end, got, 0, 0);
+
+        got = variants[i].find_literal_stop(data, position, length);
+        if (got != expected_stop)
+            ReportFailure("FindLiteralStop", variants[i].name, data, position, length, expected_stop, got, 0, 0);
+
+        checks++;
+    }
+}
+
+// Copies the contents into a buffer of exactly their length and checks every position of it
+static void CheckBuffer(const char *contents, size_t length)
+{
+    // malloc(0) may return NULL, the helpers never dereference an empty buffer anyway
+    char *data = malloc(length ? length : 1);
+    if (data == NULL)
+    {
+        fprintf(stderr, "simd_scan_test: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(data, contents, length);
+    for (size_t position = 0; position <= length; position++)
+        CheckPosition(data, position, length);
+
+    free(data);
+}
+
+// Mostly the characters the helpers stop at (or skip), so the runs are of every length, and some bytes above 127
+static char RandomCharacter(void)
+{
+    static const char alphabet[] = " \t\n\v\f\r\"\\ax0/";
+    int choice = rand() % 20;
+    if (choice < 12)
+        return alphabet[choice];
+    if (choice < 16)
+        return ' '; // long whitespace runs
+    return (char)(rand() % 256);
+}
+
+int main(void)
+{
+    AddVariants();
+    srand(24);
+
+    char contents[MAX_LENGTH];
+
+    // Runs of a single character which end exactly at the end of the buffer, at and around the block boundaries
+    const char runs[] = {' ', '\n', '\t', 'a'};
+    for (size_t run = 0; run < sizeof(runs); run++)
+    {
+        for (size_t length = 0; length <= 3 * 32 + 1; length++)
+        {
+            memset(contents, runs[run], length);
+            CheckBuffer(contents, length);
+
+            // and with the stop character as the last byte of the buffer
+            if (length != 0)
+            {
+                contents[length - 1] = runs[run] == 'a' ? '\n' : 'a';
+                CheckBuffer(contents, length);
+                contents[length - 1] = '"';
+                CheckBuffer(contents, length);
+            }
+        }
+    }
+
+    // Random buffers, half of them shorter than a single AVX2 block
+    for (int i = 0; i < RANDOM_BUFFERS; i++)
+    {
+        size_t length = rand() % 2 ? (size_t)(rand() % 33) : (size_t)(rand() % (MAX_LENGTH + 1));
+        for (size_t j = 0; j < length; j++)
+            contents[j] = RandomCharacter();
+        CheckBuffer(contents, length);
+    }
+
+    printf("simd_scan_test: %lu checks of %d variants, %d failures\n", checks, variant_count, failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file symtable_bench.c
+ * @brief Microbenchmark for the table of functions (InsertFunctionSymbol/FindFunctionSymbol)
+ *
+ * Fills the global symtable with 1k, 10k and 100k functions (or the counts given as arguments) and looks them up
+ * in a random order, once in the swiss table and once in the old linear probing table for comparison.
+ * Half of the lookups are misses (names of variables), like the checks of InsertVariableSymbol().
+ * Build and run from the src folder: make symtable-bench && ./symtable_bench [count...]
+ *
+ * @authors
+ * - Igor Lacko [xlackoi00]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "symtable.h"
+#include "stack.h"
+#include "interner.h"
+#include "expression_parser.h"
+
+// How many lookups are timed for every table size
+#define LOOKUPS 4000000
+
+// The original implementation, linear probing with step 1 over 24 byte entries with a void * and a type tag
+typedef struct
+{
+    int symbol_type;
+    void *symbol;
+    bool is_occupied;
+} LinearEntry;
+
+typedef struct
+{
+    unsigned long capacity;
+    unsigned long size;
+    LinearEntry *table;
+} LinearTable;
+
+static void LinearInsert(LinearTable *table, FunctionSymbol *func);
+
+static void LinearGrow(LinearTable *table)
+{
+    LinearTable grown = {table->capacity * 2, 0, calloc(table->capacity * 2, sizeof(LinearEntry))};
+    for (unsigned long i = 0; i < table->capacity; i++)
+    {
+        if (table->table[i].is_occupied)
+            LinearInsert(&grown, table->table[i].symbol);
+    }
+
+    free(table->table);
+    *table = grown;
+}
+
+static void LinearInsert(LinearTable *table, FunctionSymbol *func)
+{
+    if (table->size + 1 > table->capacity / 4 * 3)
+        LinearGrow(table);
+
+    unsigned long index = (unsigned long)func->symbol_id % table->capacity;
+    while (table->table[index].is_occupied)
+        index = (index + 1) % table->capacity;
+
+    table->table[index] = (LinearEntry){0, func, true};
+    table->size++;
+}
+
+static FunctionSymbol *LinearFind(LinearTable *table, int symbol_id)
+{
+    unsigned long index = (unsigned long)symbol_id % table->capacity;
+    unsigned long start_index = index;
+    while (table->table[index].is_occupied)
+    {
+        if (table->table[index].symbol_type == 0 && ((FunctionSymbol *)table->table[index].symbol)->symbol_id == symbol_id)
+            return table->table[index].symbol;
+
+        index = (index + 1) % table->capacity;
+        if (index == start_index)
+            break;
+    }
+
+    return NULL;
+}
+
+// The expression stacks in stack.o need the precedence table, which isn't linked in (expressions are never parsed here)
+PtableKey GetPtableKey(Token *token, int bracket_count)
+{
+    (void)token;
+    (void)bracket_count;
+    return 0;
+}
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void Bench(int count)
+{
+    // every function is followed by a few of its variables in the source, so their ids are interleaved
+    FunctionSymbol **functions = malloc(count * sizeof(FunctionSymbol *));
+    int *lookups = malloc(2 * count * sizeof(int));
+    char name[32];
+    for (int i = 0; i < count; i++)
+    {
+        functions[i] = FunctionSymbolInit();
+        sprintf(name, "function%d", i);
+        functions[i]->symbol_id = lookups[2 * i] = InternString(name, strlen(name));
+        sprintf(name, "variable%d", i);
+        lookups[2 * i + 1] = InternString(name, strlen(name));
+    }
+
+    // the lookups come in a random order, the parser doesn't call the functions in the order they were defined in
+    srand(count);
+    for (int i = 2 * count - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1), swap = lookups[i];
+        lookups[i] = lookups[j];
+        lookups[j] = swap;
+    }
+
+    Parser parser = {.global_symtable = InitSymtable(SYMTABLE_INITIAL_CAPACITY), .symtable_stack = SymtableStackInit()};
+    LinearTable linear = {SYMTABLE_INITIAL_CAPACITY, 0, calloc(SYMTABLE_INITIAL_CAPACITY, sizeof(LinearEntry))};
+
+    double start = Seconds();
+    for (int i = 0; i < count; i++)
+        LinearInsert(&linear, functions[i]);
+    double linear_insert = Seconds() - start;
+
+    start = Seconds();
+    for (int i = 0; i < count; i++)
+        InsertFunctionSymbol(&parser, functions[i]);
+    double swiss_insert = Seconds() - start;
+
+    // Both tables have to find the same symbols, otherwise the numbers don't mean anything
+    for (int i = 0; i < 2 * count; i++)
+    {
+        if (LinearFind(&linear, lookups[i]) != FindFunctionSymbol(parser.global_symtable, lookups[i]))
+        {
+            fprintf(stderr, "Mismatch on \"%s\"\n", InternedName(lookups[i]));
+            exit(1);
+        }
+    }
+
+    // volatile so that the loops aren't optimized away
+    volatile unsigned long found = 0;
+
+    start = Seconds();
+    for (int i = 0; i < LOOKUPS; i++)
+        found += LinearFind(&linear, lookups[i % (2 * count)]) != NULL;
+    double linear_find = Seconds() - start;
+
+    start = Seconds();
+    for (int i = 0; i < LOOKUPS; i++)
+        found += FindFunctionSymbol(parser.global_symtable, lookups[i % (2 * count)]) != NULL;
+    double swiss_find = Seconds() - start;
+
+    printf("%d functions (%lu slots, %lu bytes per slot before, %lu after):\n", count, parser.global_symtable->capacity,
+           (unsigned long)sizeof(LinearEntry), (unsigned long)(sizeof(SymtableSlot) + 1));
+    printf("  insert: linear probing %.2f ns, swiss table %.2f ns\n", linear_insert / count * 1e9, swiss_insert / count * 1e9);
+    printf("  lookup: linear probing %.2f ns, swiss table %.2f ns (%.1fx)\n",
+           linear_find / LOOKUPS * 1e9, swiss_find / LOOKUPS * 1e9, linear_find / swiss_find);
+
+    // the symtable destroys the functions
+    free(linear.table);
+    DestroySymtable(parser.global_symtable);
+    SymtableStackDestroy(parser.symtable_stack);
+    free(functions);
+    free(lookups);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        Bench(1000);
+        Bench(10000);
+        Bench(100000);
+    }
+
+    for (int i = 1; i < argc; i++)
+        Bench(atoi(argv[i]));
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 import os
 import subprocess
+import sys
+import tempfile
 
 # Directory with test cases
 # pre ostatnych: ~/ifj-project-2024/tests/test_files
@@ -21,6 +23,17 @@ INTERNAL_ERROR = 99
 
 # Expected error codes for each test file
 expected_errors = {
+    '0no_err_13.ifj24': SUCCESS,
+    '0no_err_14.ifj24': SUCCESS,
+    '0no_err_15.ifj24': SUCCESS,
+    '0no_err_16.ifj24': SUCCESS,
+    '0no_err_17.ifj24': SUCCESS,
+    '11_folding_01.ifj24': SUCCESS,
+    '11_folding_02.ifj24': SUCCESS,
+    '11_folding_03.ifj24': SUCCESS,
+    '11_folding_04.ifj24': SUCCESS,
+    '11_folding_05.ifj24': SUCCESS,
+    '11_folding_06.ifj24': SUCCESS,
     '1lex_err_01.ifj24': LEXICAL_ERROR,
     '1lex_err_02.ifj24': LEXICAL_ERROR,
     '1lex_err_03.ifj24': LEXICAL_ERROR,
@@ -45,6 +58,11 @@ expected_errors = {
     '2synt_err_10.ifj24': SYNTACTIC_ERROR,
     '2synt_err_11.ifj24': SYNTACTIC_ERROR,
     '2synt_err_12.ifj24': SYNTACTIC_ERROR,
+    '2synt_err_13.ifj24': SYNTACTIC_ERROR,
+    '2synt_err_14.ifj24': SYNTACTIC_ERROR,
+    '2synt_err_15.ifj24': SYNTACTIC_ERROR,
+    '2synt_err_16.ifj24': SYNTACTIC_ERROR,
+    '2synt_err_17.ifj24': SYNTACTIC_ERROR,
     '3sem_err_undefined_01.ifj24': SEMANTIC_ERROR_UNDEFINED,
     '3sem_err_undefined_02.ifj24': SEMANTIC_ERROR_UNDEFINED,
     '3sem_err_undefined_03.ifj24': SEMANTIC_ERROR_UNDEFINED,
@@ -87,6 +105,11 @@ expected_errors = {
     '7sem_err_noncomp_06.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
     '7sem_err_noncomp_07.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
     '7sem_err_noncomp_08.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
+    '7sem_err_noncomp_09.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
+    '7sem_err_noncomp_10.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
+    '7sem_err_noncomp_11.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
+    '7sem_err_noncomp_12.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
+    '7sem_err_noncomp_13.ifj24': SEMANTIC_ERROR_TYPE_COMPATIBILITY,
     '8sem_err_type_01.ifj24': SEMANTIC_ERROR_TYPE_DERIVATION,
     '8sem_err_type_02.ifj24': SEMANTIC_ERROR_TYPE_DERIVATION,
     '8sem_err_type_03.ifj24': SEMANTIC_ERROR_TYPE_DERIVATION,
@@ -109,24 +132,155 @@ expected_errors = {
 # pre ostatnych co testuju: ~/ifj-project-2024/src/ifj24
 compiler_path = './ifj24'
 
-# Run each test and check output
+# Both expression engines (-e) have to give the same exit code and the same code for every file
+engines = ['table', 'precedence']
+
+# The compiler built without constant folding (make nofold), it has to give the same exit code for every file
+nofold_path = './ifj24nofold'
+
+# If the IFJcode24 interpreter is there (or given as the argument), the folded and the unfolded code are run and compared
+interpreter_path = sys.argv[1] if len(sys.argv) > 1 else '../interpreter/ic24int'
+
+# Pieces of the folded code of the folding tests: what's computed at compile time and what has to be left to run time
+folded_code = {
+    '11_folding_01.ifj24': ['PUSHS int@65536\nPUSHS int@32768\nMULS\n', 'PUSHS int@2147483647\nPUSHS int@1\nADDS\n'],
+    '11_folding_02.ifj24': ['PUSHS int@2\n', 'PUSHS float@0x1p-2\n', 'PUSHS int@7\nPUSHS int@0\nIDIVS\n'],
+    '11_folding_03.ifj24': ['PUSHS int@3\n', 'PUSHS int@-3\n', 'PUSHS int@-6\n', 'PUSHS float@0x1.cp+1\n'],
+    '11_folding_04.ifj24': ['PUSHS float@0x1.8p+0\n', 'PUSHS float@0x1.cp+1\n', 'PUSHS LF@y\nPUSHS int@4\nINT2FLOATS\nMULS\n', 'PUSHS bool@true\n'],
+    '11_folding_05.ifj24': ['PUSHS LF@x\nPUSHS int@3600\nMULS\n', 'PUSHS LF@x\nPUSHS int@6\nADDS\n', 'PUSHS LF@x\nPUSHS int@5\nMULS\nPUSHS int@0\nMULS\n',
+                            'PUSHS LF@x\nPUSHS int@0\nMULS\nPUSHS int@5\nMULS\n', 'PUSHS LF@x\nPUSHS int@60\nMULS\n'],
+    '11_folding_06.ifj24': ['PUSHS bool@true\n', 'PUSHS bool@false\n', 'PUSHS LF@i\nPUSHS int@5\nLTS\n'],
+}
+
+failed = 0
+
+def run_compiler(file_path, args):
+    with open(file_path, 'r') as test_input:
+        # Run the compiler with file input redirection, error messages can contain garbage so they are decoded leniently
+        return subprocess.run([compiler_path] + args, stdin=test_input, capture_output=True, text=True, errors='replace', timeout=5)
+
+# Run each test and check the exit code
 for test_file, expected_code in expected_errors.items():
     file_path = os.path.join(test_dir, test_file)
     print(f"Running test: {test_file}")
 
     try:
-        with open(file_path, 'r') as test_input:
-            # Run the compiler with file input redirection
-            result = subprocess.run([compiler_path], stdin=test_input, capture_output=True, text=True, timeout=5)
-            actual_code = result.returncode
-            # print(f"Output:\n{result.stdout}")
-            # print(f"Error (if any):\n{result.stderr}")
-
-            # Check if the result matches the expected error code
-            if actual_code == expected_code:
-                print(f"✅ Test passed for {test_file} (Expected: {expected_code}, Got: {actual_code})")
-            else:
-                print(f"❌ Test failed for {test_file} (Expected: {expected_code}, Got: {actual_code})")
-                print(f"Output: {result.stderr.strip()}")
+        result = run_compiler(file_path, [])
+        actual_code = result.returncode
+        # print(f"Output:\n{result.stdout}")
+        # print(f"Error (if any):\n{result.stderr}")
+
+        # Check if the result matches the expected error code
+        if actual_code == expected_code:
+            print(f"✅ Test passed for {test_file} (Expected: {expected_code}, Got: {actual_code})")
+        else:
+            failed += 1
+            print(f"❌ Test failed for {test_file} (Expected: {expected_code}, Got: {actual_code})")
+            print(f"Output: {result.stderr.strip()}")
     except subprocess.TimeoutExpired:
+        failed += 1
         print(f"❌ Test timed out for {test_file}")
+
+# Run every file of the corpus with both expression engines and compare them
+for test_file in sorted(os.listdir(test_dir)):
+    file_path = os.path.join(test_dir, test_file)
+    print(f"Comparing expression engines: {test_file}")
+
+    try:
+        results = [run_compiler(file_path, ['-e', engine]) for engine in engines]
+        codes = [result.returncode for result in results]
+
+        # The expected exit code is checked above, here the engines only have to agree
+        if codes[0] != codes[1]:
+            failed += 1
+            print(f"❌ Engines differ for {test_file} (Exit codes: {codes})")
+        elif results[0].stdout != results[1].stdout:
+            failed += 1
+            print(f"❌ Engines differ for {test_file} (Generated code differs)")
+        else:
+            print(f"✅ Engines agree for {test_file} (Got: {codes[0]})")
+    except subprocess.TimeoutExpired:
+        failed += 1
+        print(f"❌ Engines timed out for {test_file}")
+
+def run_interpreter(code):
+    with tempfile.NamedTemporaryFile('w', suffix='.ifjcode') as code_file:
+        code_file.write(code)
+        code_file.flush()
+        result = subprocess.run([interpreter_path, code_file.name], stdin=subprocess.DEVNULL, capture_output=True, text=True, errors='replace', timeout=5)
+        return result.returncode, result.stdout
+
+# Compare the folded code with the code of the compiler built without folding
+if not os.path.exists(nofold_path):
+    print(f"Skipping the folding tests, {nofold_path} wasn't built (make nofold)")
+else:
+    for test_file in sorted(os.listdir(test_dir)):
+        file_path = os.path.join(test_dir, test_file)
+        print(f"Comparing folded code: {test_file}")
+
+        try:
+            folded = run_compiler(file_path, [])
+            with open(file_path, 'r') as test_input:
+                unfolded = subprocess.run([nofold_path], stdin=test_input, capture_output=True, text=True, errors='replace', timeout=5)
+
+            missing = [piece for piece in folded_code.get(test_file, []) if piece not in folded.stdout]
+            if folded.returncode != unfolded.returncode:
+                failed += 1
+                print(f"❌ Folding changed the exit code of {test_file} (Folded: {folded.returncode}, Unfolded: {unfolded.returncode})")
+            elif missing:
+                failed += 1
+                print(f"❌ Folded code of {test_file} is missing: {missing}")
+            elif len(folded.stdout.splitlines()) > len(unfolded.stdout.splitlines()):
+                failed += 1
+                print(f"❌ Folded code of {test_file} is longer than the unfolded one")
+            elif folded.returncode == SUCCESS and os.path.exists(interpreter_path) and run_interpreter(folded.stdout) != run_interpreter(unfolded.stdout):
+                failed += 1
+                print(f"❌ Folded code of {test_file} runs differently than the unfolded one")
+            else:
+                print(f"✅ Folding agrees for {test_file} (Got: {folded.returncode})")
+        except subprocess.TimeoutExpired:
+            failed += 1
+            print(f"❌ Folding timed out for {test_file}")
+
+# The parallel scanner (-j) only splits programs larger than its chunks (256 KiB), so a program over 1 MiB is generated,
+# it has to compile to the same code as with the serial scanner, and so do copies of it with a lexical and a semantic error
+# near its end (the error messages carry the line numbers, which the chunks shift)
+parallel_threads = '4'
+with tempfile.TemporaryDirectory() as parallel_dir:
+    program_path = os.path.join(parallel_dir, 'parallel.ifj24')
+    error_path = os.path.join(parallel_dir, 'parallel_error.ifj24')
+    undefined_path = os.path.join(parallel_dir, 'parallel_undefined.ifj24')
+    subprocess.run([sys.executable, os.path.join(os.path.dirname(os.path.abspath(__file__)), 'bench.py'),
+                    '--functions', '2000', '--emit', program_path], check=True)
+
+    with open(program_path, 'r') as program_file:
+        program = program_file.read()
+    declaration = 'var counter: i32 = 0;'
+    error_position = program.rindex(declaration)
+    with open(error_path, 'w') as error_file:
+        error_file.write(program[:error_position] + 'var counter: i32 = 0 $;' + program[error_position + len(declaration):])
+    statement = 'counter = counter + k;'
+    undefined_position = program.rindex(statement)
+    with open(undefined_path, 'w') as undefined_file:
+        undefined_file.write(program[:undefined_position] + 'counter = counter + undefined;' + program[undefined_position + len(statement):])
+
+    for test_file, expected_code in [(program_path, SUCCESS), (error_path, LEXICAL_ERROR), (undefined_path, SEMANTIC_ERROR_UNDEFINED)]:
+        print(f"Comparing parallel scanning (-j {parallel_threads}): {os.path.basename(test_file)}")
+        try:
+            serial = subprocess.run([compiler_path, test_file], capture_output=True, text=True, errors='replace', timeout=60)
+            parallel = subprocess.run([compiler_path, '-j', parallel_threads, test_file], capture_output=True, text=True, errors='replace', timeout=60)
+
+            if serial.returncode != expected_code or parallel.returncode != expected_code:
+                failed += 1
+                print(f"❌ Parallel scanning failed (Expected: {expected_code}, Serial: {serial.returncode}, Parallel: {parallel.returncode})")
+            elif serial.stdout != parallel.stdout or serial.stderr != parallel.stderr:
+                failed += 1
+                print(f"❌ Parallel scanning differs from the serial one for {os.path.basename(test_file)}")
+            else:
+                print(f"✅ Parallel scanning agrees (Got: {parallel.returncode})")
+        except subprocess.TimeoutExpired:
+            failed += 1
+            print(f"❌ Parallel scanning timed out for {os.path.basename(test_file)}")
+
+print(f"{failed} test(s) failed")
+sys.exit(1 if failed else 0)